@@ -1,23 +1,44 @@
 #pragma once
+#include <atomic>
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <type_traits>
+#include <utility>
 #include "Sequence.hpp"
 #include "DynamicArray.hpp"
 
+// Copies share their storage until one of them changes it, so copying a
+// sequence that is only read afterwards is O(1). The non-const operator[],
+// get_data(), begin() and end() hand out writable references, so they take
+// a private copy first; get(), as_span() and the const overloads only read
+// and never copy, so a const sequence may be read from several threads.
 template <typename T>
 class ArraySequence : public Sequence<T>
 {
-private:
+protected:
     DynamicArray<T> array;
 
+    explicit ArraySequence(InlineBuffer<T> buffer);
+
+    // Views writing into the storage (see pin()); copies do not share it
+    // while there are any.
+    std::atomic<int> views{0};
+
+    static DynamicArray<T> copy_of(
+        const ArraySequence<T>& other, std::pmr::memory_resource* resource);
+
+    template <typename> friend class ArraySequence;
+
 public:
     ArraySequence() = default;
-    ArraySequence(int initial_size);
-    ArraySequence(const T* arr, int count);
+    explicit ArraySequence(std::pmr::memory_resource* resource);
+    ArraySequence(int initial_size, std::pmr::memory_resource* resource = nullptr);
+    ArraySequence(const T* arr, int count, std::pmr::memory_resource* resource = nullptr);
     ArraySequence(const ArraySequence<T>& other);
-    ArraySequence(ArraySequence<T>&& other) noexcept;
+    ArraySequence(ArraySequence<T>&& other);
     ArraySequence(const Sequence<T>& seq);
+    ArraySequence(const Sequence<T>& seq, std::pmr::memory_resource* resource);
     ~ArraySequence() override = default;
 
     ArraySequence<T>* append(const T& item) override;
@@ -26,38 +47,111 @@ public:
     ArraySequence<T>* remove(int index) override;
     ArraySequence<T>* insert_at(int index, const Sequence<T>* other_seq) override;
 
-    T& get(int index) const override;
+    ArraySequence<T>* append_range(const T* items, int count);
+    ArraySequence<T>* insert_range(int index, const T* items, int count);
+    ArraySequence<T>* erase_range(int start_index, int end_index);
+    ArraySequence<T>* reserve(int capacity);
+
+    const T& get(int index) const override;
+    T& operator[](int index);
+    const T& operator[](int index) const;
     T get_first() const override;
     T get_last() const override;
 
     int get_size() const override;
+    int get_capacity() const;
+    std::pmr::memory_resource* get_memory_resource() const;
+
+    T* get_data();
+    const T* get_data() const;
+    T* begin();
+    const T* begin() const;
+    T* end();
+    const T* end() const;
+    Span<const T> as_span() const override;
+
+    // For views that write into the storage, such as SliceSequence: gives
+    // this sequence a block of its own and keeps copies from sharing it
+    // until the matching unpin(), so writes through the view reach this
+    // sequence and nothing else, and the block stays put unless this
+    // sequence grows, shrinks or is moved from.
+    T* pin();
+    void unpin();
 
     ArraySequence<T>* get_subsequence(int start_index, int end_index) const override;
     ArraySequence<T>* map(std::function<T(T)> func ) override;
     ArraySequence<T>* reset() override;
 
+    // Callable is taken as a template parameter so it can be inlined; the
+    // result is returned by value and may change the element type.
+    template <typename F>
+    auto map_to(F&& func) const
+        -> ArraySequence<std::decay_t<std::invoke_result_t<F&, const T&>>>;
+
+    // Replaces every element with func(element) without allocating.
+    template <typename F>
+    ArraySequence<T>* transform(F&& func);
+
     ArraySequence<T>& operator=(const ArraySequence<T>& other);
-    ArraySequence<T>& operator=(ArraySequence<T>&& other) noexcept;
+    ArraySequence<T>& operator=(ArraySequence<T>&& other);
 };
 
     
     template <typename T>
-    ArraySequence<T>::ArraySequence(int initial_size) : array(initial_size) {} 
+    ArraySequence<T>::ArraySequence(InlineBuffer<T> buffer) : array(buffer) {}
 
+    // Storage from the same resource is shared unless a view has pinned it;
+    // anything else is copied into the requested resource.
     template <typename T>
-    ArraySequence<T>::ArraySequence(const T* arr, int count) : array(arr, count) {}
+    DynamicArray<T> ArraySequence<T>::copy_of(
+        const ArraySequence<T>& other, std::pmr::memory_resource* resource) {
+        if (other.array.get_memory_resource() == resource &&
+            other.views.load(std::memory_order_acquire) == 0)
+            return other.array.share();
+        return DynamicArray<T>(other.array, resource);
+    }
+
+    template <typename T>
+    ArraySequence<T>::ArraySequence(std::pmr::memory_resource* resource) : array(resource) {}
 
     template <typename T>
-    ArraySequence<T>::ArraySequence(const ArraySequence<T>& other) : array(other.array) {}
+    ArraySequence<T>::ArraySequence(int initial_size, std::pmr::memory_resource* resource)
+    : array(initial_size, resource) {} 
 
     template <typename T>
-    ArraySequence<T>::ArraySequence(ArraySequence<T>&& other) noexcept
+    ArraySequence<T>::ArraySequence(const T* arr, int count, std::pmr::memory_resource* resource)
+    : array(arr, count, resource) {}
+
+    template <typename T>
+    ArraySequence<T>::ArraySequence(const ArraySequence<T>& other)
+    : array(copy_of(other, nullptr)) {}
+
+    template <typename T>
+    ArraySequence<T>::ArraySequence(ArraySequence<T>&& other)
     : array(std::move(other.array)) {} 
 
     template <typename T>
-    ArraySequence<T>::ArraySequence(const Sequence<T>& seq) : array(seq.get_size()) {
-        for (int i = 0; i < seq.get_size(); i++) {
-            array.set(i, seq.get(i));
+    ArraySequence<T>::ArraySequence(const Sequence<T>& seq) : ArraySequence(seq, nullptr) {}
+
+    template <typename T>
+    ArraySequence<T>::ArraySequence(const Sequence<T>& seq, std::pmr::memory_resource* resource)
+    : array(resource) {
+        if (auto other = dynamic_cast<const ArraySequence<T>*>(&seq)) {
+            array = copy_of(*other, resource);
+            return;
+        }
+
+        int size = seq.get_size();
+
+        Span<const T> contiguous = seq.as_span();
+        if (contiguous.data() || size == 0) {
+            array.append_range(contiguous.data(), size);
+            return;
+        }
+
+        array.reserve(size);
+        for (int i = 0; i < size; i++) {
+            array.push_back(seq.get(i));
         }
     }
 
@@ -82,11 +176,7 @@ public:
 
     template <typename T>
     ArraySequence<T>* ArraySequence<T>::remove(int index) {
-        for (int i = index; i < array.get_size() - 1; i++) {
-            array.set(i, array.get(i + 1));
-        }
-
-        array.resize(array.get_size() - 1);
+        array.erase_range(index, 1);
         return this;
     }
 
@@ -100,51 +190,65 @@ public:
             throw std::invalid_argument("Other sequence cannot be null");
         }
 
-        int other_size = other_seq->get_size();
-
-        if (index == array.get_size()) {
-            for (int i = 0; i < other_size; i++) {
-                array.push_back(other_seq->get(i));
-            }
+        Span<const T> contiguous = other_seq->as_span();
+        if (contiguous.data()) {
+            array.insert_range(index, contiguous.data(), static_cast<int>(contiguous.size()));
             return this;
         }
 
-        if (index == 0) {
+        const ArraySequence<T> copy(*other_seq, array.get_memory_resource());
+        array.insert_range(index, copy.get_data(), copy.get_size());
+        return this;
+    }
 
-            for (int i = other_size - 1; i >= 0; --i) {
-                array.push_front(other_seq->get(i));
-            }
-            return this;
-        }
+    template <typename T>
+    ArraySequence<T>* ArraySequence<T>::append_range(const T* items, int count) {
+        array.append_range(items, count);
+        return this;
+    }
 
-        DynamicArray<T> temp;
-        
-        for (int i = 0; i < index; i++) {
-            temp.push_back(array.get(i));
-        }
-        
-        for (int i = 0; i < other_size; i++) {
-            temp.push_back(other_seq->get(i));
-        }
-        
-        for (int i = index; i < array.get_size(); i++) {
-            temp.push_back(array.get(i));
-        }
-        
-        array = std::move(temp);
+    template <typename T>
+    ArraySequence<T>* ArraySequence<T>::insert_range(int index, const T* items, int count) {
+        array.insert_range(index, items, count);
+        return this;
+    }
+
+    template <typename T>
+    ArraySequence<T>* ArraySequence<T>::erase_range(int start_index, int end_index) {
+        if (start_index < 0 || end_index >= array.get_size() || start_index > end_index)
+            throw std::out_of_range("Invalid erase range");
+
+        array.erase_range(start_index, end_index - start_index + 1);
+        return this;
+    }
+
+    template <typename T>
+    ArraySequence<T>* ArraySequence<T>::reserve(int capacity) {
+        array.reserve(capacity);
         return this;
     }
 
     template <typename T>
-    T& ArraySequence<T>::get(int index) const {
+    const T& ArraySequence<T>::get(int index) const {
         return array.get(index);
     }
 
+    template <typename T>
+    T& ArraySequence<T>::operator[](int index) {
+        array.unshare();
+        return array[index];
+    }
+
+    template <typename T>
+    const T& ArraySequence<T>::operator[](int index) const {
+        return array[index];
+    }
+
     template <typename T>
     T ArraySequence<T>::get_first() const {
         if (array.get_size() == 0)
             throw std::runtime_error("Sequence is empty");
-        return array.get(0);
+        return array[0];
     }
 
     template <typename T>
@@ -152,7 +256,7 @@ public:
         int vector_size = array.get_size();
         if (vector_size == 0)
             throw std::runtime_error("Sequence is empty");
-        return array.get(vector_size - 1);
+        return array[vector_size - 1];
     }
 
     template <typename T>
@@ -160,6 +264,66 @@ public:
         return array.get_size();
     }
 
+    template <typename T>
+    int ArraySequence<T>::get_capacity() const {
+        return array.get_capacity();
+    }
+
+    template <typename T>
+    std::pmr::memory_resource* ArraySequence<T>::get_memory_resource() const {
+        return array.get_memory_resource();
+    }
+
+    template <typename T>
+    T* ArraySequence<T>::get_data() {
+        array.unshare();
+        return array.get_data();
+    }
+
+    template <typename T>
+    const T* ArraySequence<T>::get_data() const {
+        return array.get_data();
+    }
+
+    template <typename T>
+    T* ArraySequence<T>::begin() {
+        array.unshare();
+        return array.begin();
+    }
+
+    template <typename T>
+    const T* ArraySequence<T>::begin() const {
+        return array.begin();
+    }
+
+    template <typename T>
+    T* ArraySequence<T>::end() {
+        array.unshare();
+        return array.end();
+    }
+
+    template <typename T>
+    const T* ArraySequence<T>::end() const {
+        return array.end();
+    }
+
+    template <typename T>
+    T* ArraySequence<T>::pin() {
+        T* items = get_data();
+        views.fetch_add(1, std::memory_order_acq_rel);
+        return items;
+    }
+
+    template <typename T>
+    void ArraySequence<T>::unpin() {
+        views.fetch_sub(1, std::memory_order_acq_rel);
+    }
+
+    template <typename T>
+    Span<const T> ArraySequence<T>::as_span() const {
+        return array.as_span();
+    }
+
     template <typename T>
     ArraySequence<T>* ArraySequence<T>::get_subsequence(int start_index, int end_index) const {
         if (array.get_size() == 0)
@@ -169,26 +333,52 @@ public:
             throw std::out_of_range("Invalid subsequence range");
 
         int sub_size = end_index - start_index + 1;
-        ArraySequence<T>* sub = new ArraySequence<T>;
-
-        for (int i = start_index; i < end_index + 1; i++) {
-            T item = array.get(i);
-            sub->append(item);
-        }
 
-        return sub;
+        return new ArraySequence<T>(
+            array.get_data() + start_index, sub_size, array.get_memory_resource()
+        );
     }
 
     template <typename T>
     ArraySequence<T>* ArraySequence<T>::map(std::function<T(T)> func ) {
-        ArraySequence<T>* mapped_array = new ArraySequence<T>(array.get_size());
+        return new ArraySequence<T>(map_to(func));
+    }
 
-        for (int i = 0; i < array.get_size(); i++){
-            T mapped_item = func(array.get(i));
-            mapped_array->set(i, mapped_item);
+    template <typename T>
+    template <typename F>
+    auto ArraySequence<T>::map_to(F&& func) const
+        -> ArraySequence<std::decay_t<std::invoke_result_t<F&, const T&>>> {
+        using U = std::decay_t<std::invoke_result_t<F&, const T&>>;
+
+        int size = array.get_size();
+        const T* source = array.get_data();
+
+        if constexpr (std::is_default_constructible_v<U>) {
+            ArraySequence<U> mapped(size, array.get_memory_resource());
+            U* target = mapped.get_data();
+            for (int i = 0; i < size; i++) {
+                target[i] = func(source[i]);
+            }
+            return mapped;
+        } else {
+            ArraySequence<U> mapped(array.get_memory_resource());
+            mapped.array.reserve(size);
+            for (int i = 0; i < size; i++) {
+                mapped.array.push_back(func(source[i]));
+            }
+            return mapped;
         }
+    }
 
-        return mapped_array;
+    template <typename T>
+    template <typename F>
+    ArraySequence<T>* ArraySequence<T>::transform(F&& func) {
+        int size = array.get_size();
+        T* items = get_data();
+        for (int i = 0; i < size; i++) {
+            items[i] = func(std::as_const(items[i]));
+        }
+        return this;
     }
 
     template <typename T>
@@ -201,13 +391,13 @@ public:
     template <typename T>
     ArraySequence<T>& ArraySequence<T>::operator=(const ArraySequence<T>& other) {
         if (this != &other) {
-            array = other.array;  
+            array = copy_of(other, array.get_memory_resource());
         }
         return *this;
     }
     
     template <typename T>
-    ArraySequence<T>& ArraySequence<T>::operator=(ArraySequence<T>&& other) noexcept {
+    ArraySequence<T>& ArraySequence<T>::operator=(ArraySequence<T>&& other) {
         if (this != &other) {
             array = std::move(other.array);
         }
@@ -0,0 +1,194 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <stdexcept>
+
+#include "ArraySequence.hpp"
+#include "Generator.hpp"
+
+// A LazySequence that any number of threads may read at once. Elements live
+// in chunks that never move once allocated, and the materialized prefix is
+// published through an atomic length: a thread reading an index below it
+// takes no lock and sees the element fully written. Extending the prefix is
+// serialized by a mutex, so the generator only ever runs on one thread at a
+// time and every element is generated once.
+//
+// Chunk k holds first_chunk << k elements, so a fixed table of chunk
+// pointers covers every index and is never reallocated under a reader.
+// There is no retention policy: elements stay until the sequence dies.
+template <typename T>
+class ConcurrentLazySequence
+{
+private:
+    static constexpr size_t first_chunk_shift = 10;
+    static constexpr size_t first_chunk = size_t(1) << first_chunk_shift;
+    static constexpr size_t max_chunks = sizeof(size_t) * 8 - first_chunk_shift;
+
+    std::pmr::polymorphic_allocator<T> allocator;
+    std::unique_ptr<Generator<T>> generator;
+
+    T* chunks[max_chunks];
+    std::atomic<size_t> length;
+    std::mutex extend_mutex;
+
+    static size_t floor_log2(size_t value)
+    {
+        size_t result = 0;
+        for (size_t shift = sizeof(size_t) * 4; shift > 0; shift >>= 1)
+        {
+            if (value >> shift)
+            {
+                value >>= shift;
+                result += shift;
+            }
+        }
+        return result;
+    }
+
+    static size_t chunk_of(size_t index)
+    {
+        return floor_log2((index >> first_chunk_shift) + 1);
+    }
+
+    static size_t chunk_begin(size_t chunk)
+    {
+        return ((size_t(1) << chunk) - 1) << first_chunk_shift;
+    }
+
+    static size_t chunk_size(size_t chunk)
+    {
+        return first_chunk << chunk;
+    }
+
+    T* slot(size_t index)
+    {
+        size_t chunk = chunk_of(index);
+        if (!chunks[chunk])
+        {
+            T* items = allocator.allocate(chunk_size(chunk));
+            std::uninitialized_default_construct_n(items, chunk_size(chunk));
+            chunks[chunk] = items;
+        }
+        return chunks[chunk] + (index - chunk_begin(chunk));
+    }
+
+    // Writes the elements first and publishes them after, so a reader that
+    // sees the new length also sees every element below it.
+    void publish(const Sequence<T>& items)
+    {
+        size_t size = length.load(std::memory_order_relaxed);
+        for (int i = 0; i < items.get_size(); i++)
+            *slot(size + i) = items.get(i);
+        length.store(size + items.get_size(), std::memory_order_release);
+    }
+
+public:
+    explicit ConcurrentLazySequence(
+        std::unique_ptr<Generator<T>>&& gen,
+        std::pmr::memory_resource* resource = nullptr)
+        : allocator(resource ? resource : std::pmr::get_default_resource()),
+          generator(std::move(gen)),
+          chunks(),
+          length(0)
+    {}
+
+    // start, then rule applied to the last arity elements; see
+    // LazySequence::create.
+    ConcurrentLazySequence(
+        const Sequence<T>& start_sequence,
+        size_t arity,
+        std::function<T(const ArraySequence<T>&)> rule,
+        std::pmr::memory_resource* resource = nullptr)
+        : ConcurrentLazySequence(
+              std::make_unique<Function_Generator<T>>(start_sequence, arity, rule),
+              resource)
+    {
+        publish(start_sequence);
+    }
+
+    ConcurrentLazySequence(const ConcurrentLazySequence&) = delete;
+    ConcurrentLazySequence& operator=(const ConcurrentLazySequence&) = delete;
+
+    ~ConcurrentLazySequence()
+    {
+        for (size_t chunk = 0; chunk < max_chunks && chunks[chunk]; chunk++)
+        {
+            std::destroy_n(chunks[chunk], chunk_size(chunk));
+            allocator.deallocate(chunks[chunk], chunk_size(chunk));
+        }
+    }
+
+    static std::shared_ptr<ConcurrentLazySequence<T>> create(
+        std::unique_ptr<Generator<T>>&& gen,
+        std::pmr::memory_resource* resource = nullptr)
+    {
+        return std::make_shared<ConcurrentLazySequence<T>>(std::move(gen), resource);
+    }
+
+    static std::shared_ptr<ConcurrentLazySequence<T>> create(
+        const Sequence<T>& start_sequence,
+        size_t arity,
+        std::function<T(const ArraySequence<T>&)> rule,
+        std::pmr::memory_resource* resource = nullptr)
+    {
+        return std::make_shared<ConcurrentLazySequence<T>>(start_sequence, arity, rule, resource);
+    }
+
+    std::pmr::memory_resource* get_memory_resource() const
+    {
+        return allocator.resource();
+    }
+
+    // Lock-free once index is materialized; otherwise waits for its turn to
+    // extend the prefix, which another reader may already have done.
+    T get(size_t index)
+    {
+        if (index >= length.load(std::memory_order_acquire)
+            && generate_until(index + 1) <= index)
+        {
+            throw std::runtime_error("Index beyond possible generation");
+        }
+
+        size_t chunk = chunk_of(index);
+        return chunks[chunk][index - chunk_begin(chunk)];
+    }
+
+    // Materializes up to count elements and returns how many there are,
+    // fewer only if generation ran out.
+    size_t generate_until(size_t count)
+    {
+        size_t size = length.load(std::memory_order_acquire);
+        if (size >= count || !generator)
+            return size;
+
+        std::lock_guard<std::mutex> lock(extend_mutex);
+
+        size = length.load(std::memory_order_relaxed);
+        while (size < count)
+        {
+            // up to the end of the chunk, so the batch lands contiguously
+            size_t chunk = chunk_of(size);
+            size_t room = chunk_begin(chunk) + chunk_size(chunk) - size;
+
+            size_t produced = generator->next_batch(slot(size), std::min(count - size, room));
+            if (produced == 0)
+                break;
+
+            size += produced;
+            length.store(size, std::memory_order_release);
+        }
+
+        return size;
+    }
+
+    size_t get_materialized_count() const
+    {
+        return length.load(std::memory_order_acquire);
+    }
+};
@@ -0,0 +1,226 @@
+#pragma once
+
+// C++20 only: build with -DSEQUENCE_COROUTINES=ON.
+
+#include <coroutine>
+#include <exception>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+#include "Generator.hpp"
+
+// Return type of a coroutine that produces elements with co_yield:
+//
+//     Coroutine<int> naturals()
+//     {
+//         for (int i = 0;; ++i)
+//             co_yield i;
+//     }
+//
+//     auto lazy = LazySequence<int>::create(
+//         std::make_unique<Coroutine_Generator<int>>(naturals()));
+//
+// co_yield of another Coroutine<T> yields all of its elements. Control
+// passes into the nested coroutine and back by symmetric transfer, so a
+// chain of them runs without growing the stack, and the next element is
+// always one resume of the innermost coroutine away.
+//
+// A yielded element is not copied into the promise: it stays in the
+// coroutine frame until the next resume and is read from there. The frame
+// is allocated once per coroutine; the compiler may elide even that when a
+// Coroutine<T> does not escape the function that calls it.
+template <typename T>
+class Coroutine
+{
+public:
+    class promise_type;
+    using handle_type = std::coroutine_handle<promise_type>;
+
+    class promise_type
+    {
+        friend class Coroutine;
+
+        // root is the outermost coroutine and tracks the innermost one
+        // running below it, in leaf; parent is resumed when this one ends
+        promise_type* root = this;
+        promise_type* leaf = this;
+        handle_type parent;
+        const T* value = nullptr;
+        std::exception_ptr failure;
+
+        struct Final_Awaiter
+        {
+            bool await_ready() noexcept { return false; }
+
+            std::coroutine_handle<> await_suspend(handle_type self) noexcept
+            {
+                promise_type& promise = self.promise();
+                if (!promise.parent)
+                    return std::noop_coroutine();
+
+                promise.root->leaf = &promise.parent.promise();
+                return promise.parent;
+            }
+
+            void await_resume() noexcept {}
+        };
+
+        struct Nested_Awaiter
+        {
+            Coroutine nested;
+
+            bool await_ready() noexcept { return !nested.handle; }
+
+            std::coroutine_handle<> await_suspend(handle_type self) noexcept
+            {
+                promise_type& inner = nested.handle.promise();
+                promise_type& outer = self.promise();
+
+                inner.root = outer.root;
+                inner.parent = self;
+                outer.root->leaf = &inner;
+                return nested.handle;
+            }
+
+            // the nested coroutine has ended; its exception is rethrown
+            // here, so the yielding coroutine may catch it
+            void await_resume()
+            {
+                if (nested.handle.promise().failure)
+                    std::rethrow_exception(nested.handle.promise().failure);
+            }
+        };
+
+    public:
+        Coroutine get_return_object()
+        {
+            return Coroutine(handle_type::from_promise(*this));
+        }
+
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        Final_Awaiter final_suspend() noexcept { return {}; }
+
+        std::suspend_always yield_value(const T& item) noexcept
+        {
+            root->value = std::addressof(item);
+            return {};
+        }
+
+        Nested_Awaiter yield_value(Coroutine&& nested) noexcept
+        {
+            return Nested_Awaiter{ std::move(nested) };
+        }
+
+        void return_void() noexcept {}
+
+        void unhandled_exception()
+        {
+            failure = std::current_exception();
+        }
+
+        template <typename U>
+        void await_transform(U&&) = delete;
+    };
+
+private:
+    handle_type handle;
+
+    explicit Coroutine(handle_type handle) : handle(handle) {}
+
+public:
+    Coroutine(Coroutine&& other) noexcept
+        : handle(std::exchange(other.handle, nullptr))
+    {}
+
+    Coroutine& operator=(Coroutine&& other) noexcept
+    {
+        if (this != &other)
+        {
+            if (handle)
+                handle.destroy();
+            handle = std::exchange(other.handle, nullptr);
+        }
+        return *this;
+    }
+
+    Coroutine(const Coroutine&) = delete;
+    Coroutine& operator=(const Coroutine&) = delete;
+
+    ~Coroutine()
+    {
+        if (handle)
+            handle.destroy();
+    }
+
+    // Runs to the next element; false once the coroutine has returned.
+    bool advance()
+    {
+        if (!handle || handle.done())
+            return false;
+
+        promise_type& root = handle.promise();
+        root.value = nullptr;
+        handle_type::from_promise(*root.leaf).resume();
+
+        if (handle.done())
+        {
+            if (root.failure)
+                std::rethrow_exception(std::exchange(root.failure, nullptr));
+            return false;
+        }
+        return true;
+    }
+
+    // The element the last successful advance() stopped at.
+    const T& current() const
+    {
+        return *handle.promise().value;
+    }
+};
+
+// Generator over a Coroutine. A coroutine is resumed lazily: has_next()
+// runs it to the next co_yield, get_next() hands that element over.
+template <typename T>
+class Coroutine_Generator : public Generator<T>
+{
+private:
+    Coroutine<T> coroutine;
+    bool advanced;
+    bool finished;
+
+public:
+    explicit Coroutine_Generator(Coroutine<T>&& coroutine)
+        : coroutine(std::move(coroutine)), advanced(false), finished(false)
+    {}
+
+    bool has_next() override
+    {
+        if (!advanced && !finished)
+        {
+            finished = !coroutine.advance();
+            advanced = !finished;
+        }
+        return advanced;
+    }
+
+    T get_next() override
+    {
+        if (!has_next())
+            throw std::runtime_error("Generation limit reached");
+
+        advanced = false;
+        return coroutine.current();
+    }
+
+    size_t next_batch(T* out, size_t max) override
+    {
+        size_t count = 0;
+        while (count < max && has_next())
+        {
+            out[count++] = coroutine.current();
+            advanced = false;
+        }
+        return count;
+    }
+};
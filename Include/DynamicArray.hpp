@@ -1,116 +1,676 @@
 #pragma once
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <memory_resource>
+#include <new>
 #include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include "Span.hpp"
 
+// Caller-owned storage a DynamicArray starts in before spilling to the heap.
+template <typename T>
+struct InlineBuffer {
+    T* data;
+    int capacity;
+};
+
+// Storage is raw and uninitialized outside the live range: elements are
+// placement-constructed on demand and relocated with std::move_if_noexcept.
+// Trivially copyable types live in malloc'ed blocks so growth can go through
+// realloc.
+//
+// The live range [data, data + size) floats inside [buffer, buffer + capacity).
+// Growing at either end leaves headroom on that side, so push_back and
+// push_front are both amortized O(1).
+//
+// Blocks come from `resource` when one is given (e.g. a monotonic arena shared
+// by a whole pipeline), otherwise from the global heap. Like std::pmr
+// containers, copies use the global heap unless told otherwise and moves keep
+// the source's resource.
+//
+// Heap blocks start with a reference count, so share() can hand out another
+// array over the same block in O(1). Every mutating member copies a shared
+// block before touching it; the const accessors do not, so pointers and
+// references they return must only be read while the block may be shared
+// (call unshare() first to write through them).
 template <typename T>
 class DynamicArray {
 private:
+    static constexpr bool is_trivially_relocatable =
+        std::is_trivially_copyable_v<T> &&
+        alignof(T) <= alignof(std::max_align_t);
+
+    struct BlockHeader {
+        std::atomic<int> references;
+    };
+
+    // elements keep the alignment a bare malloc would have given them
+    static constexpr size_t block_alignment =
+        alignof(T) > alignof(std::max_align_t) ? alignof(T) : alignof(std::max_align_t);
+    static constexpr size_t header_size =
+        (sizeof(BlockHeader) + block_alignment - 1) / block_alignment * block_alignment;
+
+    T* buffer;
     T* data;
     int size;
     int capacity;
 
+    T* inline_data;
+    int inline_capacity;
+
+    std::pmr::memory_resource* resource;
+
+    // Set once the block has been handed to share(); only then does the
+    // reference count in the block header need to be consulted.
+    mutable std::atomic<bool> may_be_shared;
+
 private:
-    void ensure_capacity(int min_capacity);
+    T* allocate(int count) const;
+    void deallocate(T* ptr, int count) const;
+    static size_t block_size(int count);
+    static BlockHeader* header(T* ptr);
+    static void destroy(T* first, T* last) noexcept;
+    static void relocate(T* dest, T* src, int count) noexcept;
+
+    bool is_inline() const;
+    int front_room() const;
+    int back_room() const;
+
+    // Kept in the class body: every mutating member runs these first.
+    bool is_shared() const {
+        return may_be_shared.load(std::memory_order_relaxed) &&
+            header(buffer)->references.load(std::memory_order_acquire) > 1;
+    }
+    bool drop_reference() const noexcept;
+    void copy_shared_block();
+    void release_storage() noexcept;
+    void slide(int new_front) noexcept;
+    void reallocate(int new_capacity, int new_front);
+    void reallocate_with_gap(int index, const T* first, int count);
+    void reserve_back(int count);
+    void reserve_front(int count);
 
 public:
     DynamicArray();
-    DynamicArray(int initial_size);
-    DynamicArray(const T* arr, int count);
+    explicit DynamicArray(std::pmr::memory_resource* resource);
+    DynamicArray(int initial_size, std::pmr::memory_resource* resource = nullptr);
+    DynamicArray(const T* arr, int count, std::pmr::memory_resource* resource = nullptr);
+    explicit DynamicArray(InlineBuffer<T> buffer, std::pmr::memory_resource* resource = nullptr);
 
     DynamicArray(const DynamicArray<T>& other);
-    DynamicArray(DynamicArray<T>&& other) noexcept;
+    DynamicArray(const DynamicArray<T>& other, std::pmr::memory_resource* resource);
+    DynamicArray(DynamicArray<T>&& other);
 
     ~DynamicArray();
 
     void push_back(const T& value);
+    void push_back(T&& value);
     void push_front(const T& value);
+    void push_front(T&& value);
+    void append_range(const T* first, int count);
+    void insert_range(int index, const T* first, int count);
+    void erase_range(int index, int count);
     void set(int index, const T& value);
     T& get(int index) const;
+    T& operator[](int index) const;
+    T* get_data() const;
+    T* begin() const;
+    T* end() const;
+    Span<T> as_span() const;
     int get_size() const;
-    void resize(int index);
+    int get_capacity() const;
+    std::pmr::memory_resource* get_memory_resource() const;
+    void resize(int new_size);
+    void reserve(int new_capacity);
+    void shrink_to_fit();
     void reset();
 
+    DynamicArray<T> share() const;
+
+    // Gives this array a block of its own before writing through the
+    // pointers the const accessors return.
+    void unshare() {
+        if (may_be_shared.load(std::memory_order_relaxed))
+            copy_shared_block();
+    }
+
     DynamicArray<T>& operator=(const DynamicArray<T>& other);
-    DynamicArray<T>& operator=(DynamicArray<T>&& other) noexcept;
+    DynamicArray<T>& operator=(DynamicArray<T>&& other);
 };
 
 template <typename T>
-void DynamicArray<T>::ensure_capacity(int min_capacity) {
-    if (min_capacity <= capacity)
+size_t DynamicArray<T>::block_size(int count) {
+    return header_size + static_cast<size_t>(count) * sizeof(T);
+}
+
+template <typename T>
+typename DynamicArray<T>::BlockHeader* DynamicArray<T>::header(T* ptr) {
+    return reinterpret_cast<BlockHeader*>(reinterpret_cast<unsigned char*>(ptr) - header_size);
+}
+
+// Returns room for count elements behind a header holding one reference.
+template <typename T>
+T* DynamicArray<T>::allocate(int count) const {
+    if (count == 0)
+        return nullptr;
+
+    void* block;
+    if (resource) {
+        block = resource->allocate(block_size(count), block_alignment);
+    } else if constexpr (is_trivially_relocatable) {
+        block = std::malloc(block_size(count));
+        if (!block)
+            throw std::bad_alloc();
+    } else {
+        block = ::operator new(block_size(count), std::align_val_t(block_alignment));
+    }
+
+    ::new (block) BlockHeader{ { 1 } };
+    return reinterpret_cast<T*>(static_cast<unsigned char*>(block) + header_size);
+}
+
+template <typename T>
+void DynamicArray<T>::deallocate(T* ptr, int count) const {
+    if (!ptr)
         return;
 
-    int new_capacity = (capacity == 0) ? 1 : capacity * 2;
+    BlockHeader* block = header(ptr);
+    block->~BlockHeader();
 
-    T* new_data = new T[new_capacity];
+    if (resource)
+        resource->deallocate(block, block_size(count), block_alignment);
+    else if constexpr (is_trivially_relocatable)
+        std::free(block);
+    else
+        ::operator delete(block, std::align_val_t(block_alignment));
+}
 
-    for (int i = 0; i < size; ++i) {
-        new_data[i] = data[i];
+template <typename T>
+void DynamicArray<T>::destroy(T* first, T* last) noexcept {
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+        for (; first != last; ++first)
+            first->~T();
     }
+}
 
-    delete[] data;
+// Moves count elements from src to dest, leaving src unconstructed. The ranges
+// may overlap. Only used where element moves are known not to throw.
+template <typename T>
+void DynamicArray<T>::relocate(T* dest, T* src, int count) noexcept {
+    if (dest == src || count == 0)
+        return;
+
+    if constexpr (is_trivially_relocatable) {
+        std::memmove(static_cast<void*>(dest), static_cast<const void*>(src),
+                     static_cast<size_t>(count) * sizeof(T));
+    } else if (dest < src) {
+        for (int i = 0; i < count; ++i) {
+            ::new (static_cast<void*>(dest + i)) T(std::move(src[i]));
+            src[i].~T();
+        }
+    } else {
+        for (int i = count - 1; i >= 0; --i) {
+            ::new (static_cast<void*>(dest + i)) T(std::move(src[i]));
+            src[i].~T();
+        }
+    }
+}
+
+template <typename T>
+bool DynamicArray<T>::is_inline() const {
+    return buffer != nullptr && buffer == inline_data;
+}
+
+template <typename T>
+int DynamicArray<T>::front_room() const {
+    return static_cast<int>(data - buffer);
+}
+
+template <typename T>
+int DynamicArray<T>::back_room() const {
+    return capacity - front_room() - size;
+}
+
+
+// True when this was the last reference, i.e. the caller now owns the block
+// outright and has to destroy it.
+template <typename T>
+bool DynamicArray<T>::drop_reference() const noexcept {
+    std::atomic<int>& references = header(buffer)->references;
+    return references.load(std::memory_order_acquire) == 1 ||
+        references.fetch_sub(1, std::memory_order_acq_rel) == 1;
+}
+
+template <typename T>
+void DynamicArray<T>::release_storage() noexcept {
+    if (is_inline()) {
+        destroy(data, data + size);
+    } else if (buffer && (!may_be_shared.load(std::memory_order_relaxed) || drop_reference())) {
+        destroy(data, data + size);
+        deallocate(buffer, capacity);
+    }
+
+    may_be_shared.store(false, std::memory_order_relaxed);
+
+    buffer = inline_data;
+    data = inline_data;
+    size = 0;
+    capacity = inline_capacity;
+}
+
+template <typename T>
+void DynamicArray<T>::slide(int new_front) noexcept {
+    relocate(buffer + new_front, data, size);
+    data = buffer + new_front;
+}
+
+// Moves the live range to offset new_front of a block of new_capacity slots.
+template <typename T>
+void DynamicArray<T>::reallocate(int new_capacity, int new_front) {
+    if (inline_data != nullptr && new_capacity <= inline_capacity) {
+        if (is_inline()) {
+            slide(new_front);
+            return;
+        }
+
+        // moving back into the inline buffer
+        relocate(inline_data + new_front, data, size);
+        deallocate(buffer, capacity);
+        buffer = inline_data;
+        data = inline_data + new_front;
+        capacity = inline_capacity;
+        return;
+    }
+
+    if constexpr (is_trivially_relocatable) {
+        // realloc can only take over global heap blocks, and keeps the front offset
+        if (buffer && !resource && !is_inline() && new_front == front_room()) {
+            if (new_capacity == 0) {
+                deallocate(buffer, capacity);
+                buffer = nullptr;
+            } else {
+                void* ptr = std::realloc(header(buffer), block_size(new_capacity));
+                if (!ptr)
+                    throw std::bad_alloc();
+                buffer = reinterpret_cast<T*>(static_cast<unsigned char*>(ptr) + header_size);
+            }
+
+            data = buffer + new_front;
+            capacity = new_capacity;
+            return;
+        }
+    }
+
+    T* new_buffer = allocate(new_capacity);
+    T* new_data = new_buffer + new_front;
+    int constructed = 0;
+
+    try {
+        for (; constructed < size; ++constructed)
+            ::new (static_cast<void*>(new_data + constructed))
+                T(std::move_if_noexcept(data[constructed]));
+    } catch (...) {
+        destroy(new_data, new_data + constructed);
+        deallocate(new_buffer, new_capacity);
+        throw;
+    }
+
+    destroy(data, data + size);
+    if (!is_inline())
+        deallocate(buffer, capacity);
+
+    buffer = new_buffer;
+    data = new_data;
+    capacity = new_capacity;
+}
+
+// Copies [first, first + count) into a fresh block at position index, moving
+// the current elements around it. Leaves the array untouched if a copy throws.
+template <typename T>
+void DynamicArray<T>::reallocate_with_gap(int index, const T* first, int count) {
+    int needed = size + count;
+    int new_capacity = (capacity == 0) ? needed : capacity * 2;
+    if (new_capacity < needed)
+        new_capacity = needed;
+
+    // inserting at the front keeps headroom there for the next one
+    int new_front = (index == 0) ? (new_capacity - needed) / 2 : 0;
+
+    T* new_buffer = allocate(new_capacity);
+    T* new_data = new_buffer + new_front;
+
+    try {
+        std::uninitialized_copy_n(first, count, new_data + index);
+    } catch (...) {
+        deallocate(new_buffer, new_capacity);
+        throw;
+    }
+
+    int prefix = 0;
+    int suffix = 0;
+
+    try {
+        for (; prefix < index; ++prefix)
+            ::new (static_cast<void*>(new_data + prefix))
+                T(std::move_if_noexcept(data[prefix]));
+        for (; suffix < size - index; ++suffix)
+            ::new (static_cast<void*>(new_data + index + count + suffix))
+                T(std::move_if_noexcept(data[index + suffix]));
+    } catch (...) {
+        destroy(new_data, new_data + prefix);
+        destroy(new_data + index, new_data + index + count + suffix);
+        deallocate(new_buffer, new_capacity);
+        throw;
+    }
+
+    destroy(data, data + size);
+    if (!is_inline())
+        deallocate(buffer, capacity);
+
+    buffer = new_buffer;
     data = new_data;
+    size = needed;
     capacity = new_capacity;
 }
 
 template <typename T>
-DynamicArray<T>::DynamicArray() : data(nullptr), size(0), capacity(0) {}
+void DynamicArray<T>::reserve_back(int count) {
+    unshare();
+    if (count <= back_room())
+        return;
+
+    int needed = size + count;
+
+    // at most half full: sliding to the front frees enough room for the
+    // copy to pay for itself
+    if (needed <= capacity / 2 && std::is_nothrow_move_constructible_v<T>) {
+        slide(0);
+        return;
+    }
+
+    int new_capacity = (capacity == 0) ? 1 : capacity * 2;
+    if (new_capacity < needed + front_room())
+        new_capacity = needed + front_room();
+
+    reallocate(new_capacity, front_room());
+}
 
 template <typename T>
-DynamicArray<T>::DynamicArray(int initial_size) : size(initial_size), capacity(initial_size) {
-    data = new T[capacity];
+void DynamicArray<T>::reserve_front(int count) {
+    unshare();
+    if (count <= front_room())
+        return;
+
+    int needed = size + count;
+
+    if (needed <= capacity / 2 && std::is_nothrow_move_constructible_v<T>) {
+        slide(count + (capacity - needed) / 2);
+        return;
+    }
+
+    int new_capacity = (capacity == 0) ? 1 : capacity * 2;
+    if (new_capacity < needed)
+        new_capacity = needed;
+
+    // split the spare room evenly so both ends keep headroom
+    reallocate(new_capacity, count + (new_capacity - needed) / 2);
 }
 
 template <typename T>
-DynamicArray<T>::DynamicArray(const T* arr, int count) : size(count), capacity(count) {
-    data = new T[capacity];
-    for (int i = 0; i < count; ++i) {
-        data[i] = arr[i];
+DynamicArray<T>::DynamicArray() : DynamicArray(nullptr) {}
+
+template <typename T>
+DynamicArray<T>::DynamicArray(std::pmr::memory_resource* resource)
+    : buffer(nullptr), data(nullptr), size(0), capacity(0),
+      inline_data(nullptr), inline_capacity(0), resource(resource),
+      may_be_shared(false) {}
+
+template <typename T>
+DynamicArray<T>::DynamicArray(int initial_size, std::pmr::memory_resource* resource)
+    : DynamicArray(resource) {
+    if (initial_size < 0)
+        throw std::invalid_argument("DynamicArray size cannot be negative");
+
+    buffer = allocate(initial_size);
+    data = buffer;
+    capacity = initial_size;
+
+    try {
+        std::uninitialized_value_construct_n(data, initial_size);
+    } catch (...) {
+        deallocate(buffer, capacity);
+        throw;
     }
+    size = initial_size;
 }
 
 template <typename T>
-DynamicArray<T>::DynamicArray(const DynamicArray<T>& other) : size(other.size), capacity(other.capacity) {
-    data = new T[capacity];
-    for (int i = 0; i < size; ++i) {
-        data[i] = other.data[i];
+DynamicArray<T>::DynamicArray(const T* arr, int count, std::pmr::memory_resource* resource)
+    : DynamicArray(resource) {
+    if (count < 0)
+        throw std::invalid_argument("DynamicArray size cannot be negative");
+
+    buffer = allocate(count);
+    data = buffer;
+    capacity = count;
+
+    try {
+        std::uninitialized_copy_n(arr, count, data);
+    } catch (...) {
+        deallocate(buffer, capacity);
+        throw;
     }
+    size = count;
 }
 
 template <typename T>
-DynamicArray<T>::DynamicArray(DynamicArray<T>&& other) noexcept
-    : data(other.data), 
-      size(other.size), 
-      capacity(other.capacity) {
-    other.data = nullptr;
-    other.size = 0;
-    other.capacity = 0;
+DynamicArray<T>::DynamicArray(InlineBuffer<T> storage, std::pmr::memory_resource* resource)
+    : buffer(storage.data),
+      data(storage.data),
+      size(0),
+      capacity(storage.capacity),
+      inline_data(storage.data),
+      inline_capacity(storage.capacity),
+      resource(resource),
+      may_be_shared(false) {}
+
+template <typename T>
+DynamicArray<T>::DynamicArray(const DynamicArray<T>& other)
+    : DynamicArray(other.data, other.size) {}
+
+template <typename T>
+DynamicArray<T>::DynamicArray(const DynamicArray<T>& other, std::pmr::memory_resource* resource)
+    : DynamicArray(other.data, other.size, resource) {}
+
+template <typename T>
+DynamicArray<T>::DynamicArray(DynamicArray<T>&& other)
+    : DynamicArray(other.resource) {
+    *this = std::move(other);
 }
 
 template <typename T>
 DynamicArray<T>::~DynamicArray() {
-    delete[] data;
+    release_storage();
 }
 
+// push_back, push_front and set are marked inline so their fast path stays
+// in the caller's loop despite the extra shared-block check.
 template <typename T>
-void DynamicArray<T>::push_back(const T& value) {
-    ensure_capacity(size + 1);
-    data[size++] = value;
+inline void DynamicArray<T>::push_back(const T& value) {
+    if (back_room() > 0 && !is_shared()) {
+        ::new (static_cast<void*>(data + size)) T(value);
+        ++size;
+        return;
+    }
+
+    // value may live in the buffer that is about to be released
+    T copy(value);
+    reserve_back(1);
+    ::new (static_cast<void*>(data + size)) T(std::move(copy));
+    ++size;
 }
 
 template <typename T>
-void DynamicArray<T>::push_front(const T& value) {
-    ensure_capacity(size + 1);
-    for (int i = size; i > 0; --i) {
-        data[i] = data[i - 1];
+inline void DynamicArray<T>::push_back(T&& value) {
+    if (back_room() > 0 && !is_shared()) {
+        ::new (static_cast<void*>(data + size)) T(std::move(value));
+        ++size;
+        return;
     }
 
-    data[0] = value;
+    T moved(std::move(value));
+    reserve_back(1);
+    ::new (static_cast<void*>(data + size)) T(std::move(moved));
     ++size;
 }
 
 template <typename T>
-void DynamicArray<T>::set(int index, const T& value) {
+inline void DynamicArray<T>::push_front(const T& value) {
+    if (front_room() > 0 && !is_shared()) {
+        ::new (static_cast<void*>(data - 1)) T(value);
+        --data;
+        ++size;
+        return;
+    }
+
+    T copy(value);
+    reserve_front(1);
+    ::new (static_cast<void*>(data - 1)) T(std::move(copy));
+    --data;
+    ++size;
+}
+
+template <typename T>
+inline void DynamicArray<T>::push_front(T&& value) {
+    if (front_room() > 0 && !is_shared()) {
+        ::new (static_cast<void*>(data - 1)) T(std::move(value));
+        --data;
+        ++size;
+        return;
+    }
+
+    T moved(std::move(value));
+    reserve_front(1);
+    ::new (static_cast<void*>(data - 1)) T(std::move(moved));
+    --data;
+    ++size;
+}
+
+template <typename T>
+void DynamicArray<T>::append_range(const T* first, int count) {
+    insert_range(size, first, count);
+}
+
+// Fills the gap from whichever side has room, so a single relocation of the
+// shorter side is enough; falls back to one reallocation otherwise.
+template <typename T>
+void DynamicArray<T>::insert_range(int index, const T* first, int count) {
+    if (index < 0 || index > size)
+        throw std::out_of_range("DynamicArray::insert_range index out of range");
+    if (count < 0)
+        throw std::invalid_argument("DynamicArray::insert_range count cannot be negative");
+    if (count == 0)
+        return;
+
+    unshare();
+
+    if (first < data + size && first + count > data) {
+        DynamicArray<T> copy(first, count);
+        insert_range(index, copy.data, count);
+        return;
+    }
+
+    if (index == size) {
+        reserve_back(count);
+        std::uninitialized_copy_n(first, count, data + size);
+        size += count;
+        return;
+    }
+
+    if (!std::is_nothrow_move_constructible_v<T>) {
+        reallocate_with_gap(index, first, count);
+        return;
+    }
+
+    bool toward_front = index < size - index;
+
+    if (index == 0 && front_room() < count)
+        reserve_front(count);
+
+    if (toward_front && front_room() >= count) {
+        relocate(data - count, data, index);
+        data -= count;
+
+        try {
+            std::uninitialized_copy_n(first, count, data + index);
+        } catch (...) {
+            relocate(data + count, data, index);
+            data += count;
+            throw;
+        }
+
+        size += count;
+        return;
+    }
+
+    if (back_room() >= count) {
+        relocate(data + index + count, data + index, size - index);
+
+        try {
+            std::uninitialized_copy_n(first, count, data + index);
+        } catch (...) {
+            relocate(data + index, data + index + count, size - index);
+            throw;
+        }
+
+        size += count;
+        return;
+    }
+
+    reallocate_with_gap(index, first, count);
+}
+
+template <typename T>
+void DynamicArray<T>::erase_range(int index, int count) {
+    if (index < 0 || count < 0 || index + count > size)
+        throw std::out_of_range("DynamicArray::erase_range range out of range");
+    if (count == 0)
+        return;
+
+    unshare();
+
+    if (!std::is_nothrow_move_constructible_v<T>) {
+        std::move(data + index + count, data + size, data + index);
+        destroy(data + size - count, data + size);
+        size -= count;
+        return;
+    }
+
+    destroy(data + index, data + index + count);
+
+    if (index < size - index - count) {
+        // the prefix is shorter: close the gap from the front
+        relocate(data + count, data, index);
+        data += count;
+    } else {
+        relocate(data + index, data + index + count, size - index - count);
+    }
+
+    size -= count;
+}
+
+template <typename T>
+inline void DynamicArray<T>::set(int index, const T& value) {
     if (index < 0 || index >= size)
         throw std::out_of_range("DynamicArray::set index out of range");
+
+    unshare();
     data[index] = value;
 }
 
@@ -121,57 +681,206 @@ T& DynamicArray<T>::get(int index) const {
     return data[index];
 }
 
+// Unchecked counterpart of get() for loops that have already validated their
+// bounds; only debug builds assert.
+template <typename T>
+T& DynamicArray<T>::operator[](int index) const {
+    assert(index >= 0 && index < size);
+    return data[index];
+}
+
+template <typename T>
+T* DynamicArray<T>::get_data() const {
+    return data;
+}
+
+template <typename T>
+T* DynamicArray<T>::begin() const {
+    return data;
+}
+
+template <typename T>
+T* DynamicArray<T>::end() const {
+    return data + size;
+}
+
+template <typename T>
+Span<T> DynamicArray<T>::as_span() const {
+    return Span<T>(data, static_cast<size_t>(size));
+}
+
 template <typename T>
 int DynamicArray<T>::get_size() const {
-    return size; 
+    return size;
+}
+
+// Number of elements that fit from the current front without reallocating.
+template <typename T>
+int DynamicArray<T>::get_capacity() const {
+    return capacity - front_room();
+}
+
+template <typename T>
+std::pmr::memory_resource* DynamicArray<T>::get_memory_resource() const {
+    return resource;
+}
+
+template <typename T>
+void DynamicArray<T>::resize(int new_size) {
+    if (new_size < 0)
+        throw std::invalid_argument("DynamicArray size cannot be negative");
+
+    unshare();
+
+    if (new_size <= size) {
+        destroy(data + new_size, data + size);
+        size = new_size;
+        return;
+    }
+
+    reserve_back(new_size - size);
+    std::uninitialized_value_construct(data + size, data + new_size);
+    size = new_size;
+}
+
+template <typename T>
+void DynamicArray<T>::reserve(int new_capacity) {
+    unshare();
+    if (new_capacity > get_capacity())
+        reallocate(front_room() + new_capacity, front_room());
 }
 
 template <typename T>
-void DynamicArray<T>::resize(int index) {
-    size -= index;
+void DynamicArray<T>::shrink_to_fit() {
+    unshare();
+    if (size < capacity)
+        reallocate(size, 0);
 }
 
 template <typename T>
 void DynamicArray<T>::reset() {
-    if (!data) return;
-    delete[] data;
-    data = nullptr;
-    size = 0;
-    capacity = 0;
+    if (!buffer) return;
+    release_storage();
+}
+
+// Another array over the same block: O(1) for heap storage. Inline storage
+// belongs to its owner and is copied instead.
+template <typename T>
+DynamicArray<T> DynamicArray<T>::share() const {
+    if (!buffer || is_inline())
+        return DynamicArray<T>(*this, resource);
+
+    header(buffer)->references.fetch_add(1, std::memory_order_relaxed);
+    may_be_shared.store(true, std::memory_order_relaxed);
+
+    DynamicArray<T> shared(resource);
+    shared.buffer = buffer;
+    shared.data = data;
+    shared.size = size;
+    shared.capacity = capacity;
+    shared.may_be_shared.store(true, std::memory_order_relaxed);
+    return shared;
+}
+
+// Keeps capacity and headroom, so the copy does not change growth behaviour.
+template <typename T>
+void DynamicArray<T>::copy_shared_block() {
+    if (header(buffer)->references.load(std::memory_order_acquire) == 1) {
+        may_be_shared.store(false, std::memory_order_relaxed);
+        return;
+    }
+
+    int front = front_room();
+    T* new_buffer = allocate(capacity);
+
+    try {
+        std::uninitialized_copy_n(data, size, new_buffer + front);
+    } catch (...) {
+        deallocate(new_buffer, capacity);
+        throw;
+    }
+
+    if (drop_reference()) {
+        // the other owners let go in the meantime: keep the old block, so
+        // references into it taken by the caller stay valid
+        header(buffer)->references.store(1, std::memory_order_relaxed);
+        destroy(new_buffer + front, new_buffer + front + size);
+        deallocate(new_buffer, capacity);
+    } else {
+        buffer = new_buffer;
+        data = new_buffer + front;
+    }
+
+    may_be_shared.store(false, std::memory_order_relaxed);
 }
 
 template <typename T>
 DynamicArray<T>& DynamicArray<T>::operator=(const DynamicArray<T>& other) {
-    if (this != &other) {
-        delete[] data;
-        
-        size = other.size;
-        capacity = other.capacity;
-        
-        if (capacity > 0) {
-            data = new T[capacity];
-            for (int i = 0; i < size; ++i) {
-                data[i] = other.data[i];
-            }
-        } else {
-            data = nullptr;
-        }
+    if (this == &other)
+        return *this;
+
+    if (is_shared())
+        release_storage();
+
+    if (other.size > capacity) {
+        DynamicArray<T> copy(other, resource);
+        *this = std::move(copy);
+        return *this;
     }
+
+    destroy(data, data + size);
+    size = 0;
+    data = buffer;
+    std::uninitialized_copy_n(other.data, other.size, data);
+    size = other.size;
     return *this;
 }
 
+// Neither an inline buffer nor a block from another resource can change
+// hands, so in those cases the elements are moved one by one. That may
+// allocate and may throw, so a move is not noexcept; if it throws, this
+// array keeps the elements moved so far and other keeps all of its own.
 template <typename T>
-DynamicArray<T>& DynamicArray<T>::operator=(DynamicArray<T>&& other) noexcept {
-    if (this != &other) {
-        delete[] data;
-        
+DynamicArray<T>& DynamicArray<T>::operator=(DynamicArray<T>&& other) {
+    if (this == &other)
+        return *this;
+
+    release_storage();
+
+    bool same_resource = resource == other.resource ||
+        (resource && other.resource && resource->is_equal(*other.resource));
+
+    if (!other.is_inline() && same_resource) {
+        buffer = other.buffer;
         data = other.data;
         size = other.size;
         capacity = other.capacity;
-        
-        other.data = nullptr;
+        may_be_shared.store(other.may_be_shared.load(std::memory_order_relaxed),
+                            std::memory_order_relaxed);
+
+        other.buffer = other.inline_data;
+        other.data = other.inline_data;
         other.size = 0;
-        other.capacity = 0;
+        other.capacity = other.inline_capacity;
+        other.may_be_shared.store(false, std::memory_order_relaxed);
+        return *this;
+    }
+
+    if (other.size > capacity) {
+        buffer = allocate(other.size);
+        data = buffer;
+        capacity = other.size;
+    }
+
+    // elements of a shared block still belong to the other owners
+    if (other.is_shared()) {
+        std::uninitialized_copy_n(other.data, other.size, data);
+        size = other.size;
+    } else {
+        for (; size < other.size; ++size)
+            ::new (static_cast<void*>(data + size)) T(std::move(other.data[size]));
     }
+
+    other.release_storage();
     return *this;
-}
\ No newline at end of file
+}
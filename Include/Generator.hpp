@@ -1,154 +1,591 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
 #include <memory>
+#include <mutex>
 #include <functional>
 #include <optional>
 #include <stdexcept>
+#include <thread>
+#include <utility>
 
 #include "Sequence.hpp"
 #include "ArraySequence.hpp"
+#include "SizeHint.hpp"
+#include "SmallArraySequence.hpp"
+#include "ThreadPool.hpp"
 
 
 template <typename T>
 class LazySequence;
 
+// Pulls up to max elements into out and returns how many it wrote; 0 only
+// once exhausted. Same contract as Generator::next_batch. A null out skips
+// the elements instead, in O(1) where the source is random access.
+template <typename T>
+using Batch_Source = std::function<size_t(T* out, size_t max)>;
+
 template <typename T>
 class Generator
 {
 public:
     virtual T get_next() = 0;
     virtual bool has_next() = 0;
+
+    // Assigns up to max next elements to out[0..max) and returns how many it
+    // wrote; 0 only once the generator is exhausted. Never produces more than
+    // asked for, so pulling in batches generates exactly what get_next would.
+    virtual size_t next_batch(T* out, size_t max)
+    {
+        size_t count = 0;
+        while (count < max && has_next())
+            out[count++] = get_next();
+        return count;
+    }
+
+    // Passes over up to n elements without producing them and returns how
+    // many it passed; fewer only once exhausted. Random-access generators
+    // do this in O(1).
+    virtual size_t skip(size_t n)
+    {
+        size_t count = 0;
+        while (count < n && has_next())
+        {
+            get_next();
+            ++count;
+        }
+        return count;
+    }
+
+    // How many elements are left. Only a hint for most generators; an
+    // exact hint must be right.
+    virtual SizeHint size_hint() const
+    {
+        return SizeHint::unknown();
+    }
+
+    // Stateless generators can hand out an independent source of their whole
+    // output, from the first element on, so a stage built on top of them
+    // pulls straight through instead of reading this stage's cache. Empty
+    // for generators whose output depends on anything but their upstream.
+    virtual Batch_Source<T> fork() const
+    {
+        return nullptr;
+    }
+
+    // The element offset positions after the one get_next would return,
+    // computed without generating the ones in between. Empty for
+    // generators that can only go in order.
+    virtual std::optional<T> jump(size_t) const
+    {
+        return std::nullopt;
+    }
+
     virtual ~Generator() = default;
 };
 
+// Generator over the source its fork() returns, with one element of
+// lookahead for has_next, so the generator and every fork run the same
+// code. The source is taken on the first pull rather than at construction:
+// an upstream sequence that has been read directly by then is pulled from
+// its cache instead of having its elements computed again.
+//
+// A composite generator (append, insert) lets go of its upstream sequences
+// once it starts pulling: only the source refers to them from then on, and
+// it drops each input as that runs dry. So the parts of a long chain of
+// appends are freed as soon as they have been read, unless someone else
+// holds them. In exchange such a generator no longer forks once started.
+// The size hint is the one from the start, minus what has been pulled.
+template <typename T>
+class Pull_Generator : public Generator<T>
+{
+private:
+    Batch_Source<T> source;
+    bool started = false;
+    bool finished = false;
+    size_t pulled = 0;
+    SizeHint total = SizeHint::unknown();
+
+    // An exhausted source is dropped with everything it holds, and never
+    // asked again.
+    size_t pull(T* out, size_t max)
+    {
+        if (finished)
+            return 0;
+
+        if (!started)
+        {
+            total = total_hint();
+            source = this->fork();
+            started = true;
+            release_upstreams();
+        }
+
+        size_t produced = source(out, max);
+        if (produced == 0)
+        {
+            finished = true;
+            source = nullptr;
+        }
+
+        pulled += produced;
+        return produced;
+    }
+
+    // Pulls the rest of a skip or batch; a source may stop short of max
+    // before it is exhausted.
+    size_t pull_all(T* out, size_t max)
+    {
+        size_t count = 0;
+        while (count < max)
+        {
+            size_t produced = pull(out ? out + count : nullptr, max - count);
+            if (produced == 0)
+                break;
+            count += produced;
+        }
+        return count;
+    }
+
+protected:
+    std::optional<T> pending;
+
+    // Hint for everything the source produces, before it starts.
+    virtual SizeHint total_hint() const
+    {
+        return SizeHint::unknown();
+    }
+
+    // Drops the upstream sequences, leaving fork() to return nullptr.
+    virtual void release_upstreams() {}
+
+public:
+    Pull_Generator() = default;
+    Pull_Generator(const Pull_Generator&) = delete;
+    Pull_Generator& operator=(const Pull_Generator&) = delete;
+
+    T get_next() override
+    {
+        if (!has_next())
+            throw std::runtime_error("Generation limit reached");
+
+        T result = std::move(*pending);
+        pending.reset();
+        return result;
+    }
+
+    bool has_next() override
+    {
+        if (pending.has_value())
+            return true;
+
+        T item;
+        if (pull(&item, 1) == 0)
+            return false;
+
+        pending = std::move(item);
+        return true;
+    }
+
+    size_t next_batch(T* out, size_t max) override
+    {
+        size_t count = 0;
+        if (max > 0 && pending.has_value())
+        {
+            out[count++] = std::move(*pending);
+            pending.reset();
+        }
+
+        return count + pull_all(out + count, max - count);
+    }
+
+    size_t skip(size_t n) override
+    {
+        size_t count = 0;
+        if (n > 0 && pending.has_value())
+        {
+            pending.reset();
+            ++count;
+        }
+
+        return count + pull_all(nullptr, n - count);
+    }
+
+    SizeHint size_hint() const override
+    {
+        if (finished)
+            return SizeHint::exact(0);
+
+        SizeHint whole = started ? total : total_hint();
+        return whole.after(pulled - (pending.has_value() ? 1 : 0));
+    }
+};
+
+// Keeps the last arity values itself, so stepping costs one rule call and
+// a shift of the window: nothing is allocated and the owner's cache is
+// never read back (it may even be released).
 template <typename T>
 class Function_Generator : public Generator<T>
 {
 private:
-    std::weak_ptr<LazySequence<T>> owner;
-    std::function<T(const Sequence<T>&)> rule;
-    size_t arity;
+    static constexpr int inline_arity = 4;
+
+    std::function<T(const ArraySequence<T>&)> rule;
+    SmallArraySequence<T, inline_arity> window;
+    bool ready;
+
+    T step()
+    {
+        if (!ready)
+            throw std::runtime_error("Not enough elements to generate next");
+
+        T next = rule(window);
+        shift_window(window, next);
+        return next;
+    }
 
 public:
+    // Starts after the last arity elements of start.
     Function_Generator(
-        std::shared_ptr<LazySequence<T>> gen_owner,
+        const Sequence<T>& start,
         size_t arity,
-        std::function<T(const Sequence<T>&)> rule)
-        : owner(gen_owner), rule(rule), arity(arity)
-    {}
+        std::function<T(const ArraySequence<T>&)> rule)
+        : rule(rule),
+          window(static_cast<int>(arity)),
+          ready(static_cast<size_t>(start.get_size()) >= arity)
+    {
+        if (ready)
+            for (size_t i = 0; i < arity; i++)
+                window[i] = start.get(static_cast<int>(start.get_size() - arity + i));
+    }
+
+    // Drops the oldest value and appends next.
+    static void shift_window(ArraySequence<T>& window, const T& next)
+    {
+        int arity = window.get_size();
+        if (arity == 0)
+            return;
+
+        T* items = window.get_data();
+        std::move(items + 1, items + arity, items);
+        items[arity - 1] = next;
+    }
 
     T get_next() override
     {
-        auto locked_owner = owner.lock();
-        if (!locked_owner)
-            throw std::runtime_error("Owner sequence expired");
+        return step();
+    }
 
-        if (locked_owner->get_materialized_count() < arity)
+    size_t next_batch(T* out, size_t max) override
+    {
+        for (size_t count = 0; count < max; count++)
+            out[count] = step();
+        return max;
+    }
+
+    bool has_next() override
+    {
+        return true;
+    }
+};
+
+// x[k] = c[0] * x[k - arity] + ... + c[arity - 1] * x[k - 1]. Steps like
+// Function_Generator, and jump() reaches any later element through powers
+// of the companion matrix in O(arity^3 log offset). T needs +, * and
+// construction from 0 and 1; use unsigned or modular arithmetic for far
+// indices.
+template <typename T>
+class Linear_Recurrence_Generator : public Generator<T>
+{
+private:
+    static constexpr int inline_arity = 4;
+
+    SmallArraySequence<T, inline_arity> coefficients;
+    SmallArraySequence<T, inline_arity> window;
+    bool ready;
+
+    // out = a * b for n x n row-major matrices
+    static void multiply(const DynamicArray<T>& a, const DynamicArray<T>& b, DynamicArray<T>& out, int n)
+    {
+        for (int r = 0; r < n; r++)
+        {
+            for (int c = 0; c < n; c++)
+            {
+                T sum = T(0);
+                for (int k = 0; k < n; k++)
+                    sum = sum + a[r * n + k] * b[k * n + c];
+                out[r * n + c] = sum;
+            }
+        }
+    }
+
+public:
+    Linear_Recurrence_Generator(const Sequence<T>& start, const Sequence<T>& coefficients)
+        : coefficients(coefficients.get_size()),
+          window(coefficients.get_size()),
+          ready(start.get_size() >= coefficients.get_size())
+    {
+        int arity = coefficients.get_size();
+        for (int i = 0; i < arity; i++)
+            this->coefficients[i] = coefficients.get(i);
+
+        if (ready)
+            for (int i = 0; i < arity; i++)
+                window[i] = start.get(start.get_size() - arity + i);
+    }
+
+    T get_next() override
+    {
+        if (!ready)
             throw std::runtime_error("Not enough elements to generate next");
 
-        ArraySequence<T> args_buffer(arity);
-        size_t size = locked_owner->get_materialized_count();
+        T next = T(0);
+        for (int i = 0; i < window.get_size(); i++)
+            next = next + coefficients[i] * window[i];
 
-        for (size_t i = 0; i < arity; i++)
-            args_buffer.set(i, locked_owner->get(size - arity + i));
+        Function_Generator<T>::shift_window(window, next);
+        return next;
+    }
 
-        return rule(args_buffer);
+    size_t next_batch(T* out, size_t max) override
+    {
+        for (size_t count = 0; count < max; count++)
+            out[count] = get_next();
+        return max;
     }
 
     bool has_next() override
     {
         return true;
     }
+
+    // The window advanced offset + 1 steps is M^(offset + 1) * window, and
+    // only its last component is needed: the last row of the power times
+    // the window.
+    std::optional<T> jump(size_t offset) const override
+    {
+        if (!ready)
+            throw std::runtime_error("Not enough elements to generate next");
+
+        int n = window.get_size();
+        if (n == 0)
+            return T(0);
+
+        DynamicArray<T> base(n * n);
+        for (int i = 0; i < n * n; i++)
+            base[i] = T(0);
+        for (int r = 0; r + 1 < n; r++)
+            base[r * n + r + 1] = T(1);
+        for (int c = 0; c < n; c++)
+            base[(n - 1) * n + c] = coefficients[c];
+
+        DynamicArray<T> row(n);
+        for (int c = 0; c < n; c++)
+            row[c] = c == n - 1 ? T(1) : T(0);
+
+        DynamicArray<T> scratch(n * n);
+        DynamicArray<T> next_row(n);
+
+        for (size_t power = offset + 1; power > 0; power >>= 1)
+        {
+            if (power & 1)
+            {
+                for (int c = 0; c < n; c++)
+                {
+                    T sum = T(0);
+                    for (int k = 0; k < n; k++)
+                        sum = sum + row[k] * base[k * n + c];
+                    next_row[c] = sum;
+                }
+                std::swap(row, next_row);
+            }
+
+            if (power > 1)
+            {
+                multiply(base, base, scratch, n);
+                std::swap(base, scratch);
+            }
+        }
+
+        T result = T(0);
+        for (int c = 0; c < n; c++)
+            result = result + row[c] * window[c];
+        return result;
+    }
 };
 
+// Replays a finite sequence. Sequences that can share() their elements
+// (shared slices, ropes) are referenced as they are; anything else is
+// copied once, since the source may change or die before generation ends.
 template <typename T>
 class Sequence_Generator : public Generator<T>
 {
 private:
-    ArraySequence<T> sequence;
+    std::shared_ptr<const Sequence<T>> shared;
+    ArraySequence<T> copy;
+    const Sequence<T>* source;
+    Span<const T> items;
+    size_t start_index;
     size_t current_index;
 
+    void bind(const Sequence<T>& seq)
+    {
+        shared = seq.share();
+        if (!shared)
+            copy = ArraySequence<T>(seq, copy.get_memory_resource());
+
+        source = shared ? shared.get() : &copy;
+        items = source->as_span();
+    }
+
 public:
-    explicit Sequence_Generator(const ArraySequence<T>& seq)
-        : sequence(seq), current_index(0)
-    {}
+    explicit Sequence_Generator(const Sequence<T>& seq)
+        : start_index(0), current_index(0)
+    {
+        bind(seq);
+    }
 
-    Sequence_Generator(const ArraySequence<T>& seq, size_t index)
-        : sequence(seq), current_index(index)
-    {}
+    Sequence_Generator(
+        const Sequence<T>& seq,
+        size_t index,
+        std::pmr::memory_resource* resource = nullptr)
+        : copy(resource), start_index(index), current_index(index)
+    {
+        bind(seq);
+    }
+
+    Sequence_Generator(const Sequence_Generator&) = delete;
+    Sequence_Generator& operator=(const Sequence_Generator&) = delete;
 
     T get_next() override
     {
         if(!has_next())
             throw std::runtime_error("End of Sequence");
-        return sequence.get(current_index++);
+
+        size_t index = current_index++;
+        if (items.data())
+            return items[index];
+        return source->get(static_cast<int>(index));
+    }
+
+    size_t next_batch(T* out, size_t max) override
+    {
+        size_t size = static_cast<size_t>(source->get_size());
+        size_t count = current_index < size ? std::min(max, size - current_index) : 0;
+
+        if (items.data())
+            std::copy_n(items.data() + current_index, count, out);
+        else
+            for (size_t i = 0; i < count; i++)
+                out[i] = source->get(static_cast<int>(current_index + i));
+
+        current_index += count;
+        return count;
+    }
+
+    size_t skip(size_t n) override
+    {
+        size_t size = static_cast<size_t>(source->get_size());
+        size_t count = current_index < size ? std::min(n, size - current_index) : 0;
+        current_index += count;
+        return count;
+    }
+
+    // The fork keeps the elements alive on its own; a private copy is shared
+    // copy-on-write, not duplicated.
+    Batch_Source<T> fork() const override
+    {
+        std::shared_ptr<const Sequence<T>> elements = shared;
+        if (!elements)
+            elements = std::make_shared<ArraySequence<T>>(copy, copy.get_memory_resource());
+
+        return [elements, index = start_index](T* out, size_t max) mutable -> size_t {
+            size_t size = static_cast<size_t>(elements->get_size());
+            size_t count = index < size ? std::min(max, size - index) : 0;
+
+            if (out)
+            {
+                Span<const T> contiguous = elements->as_span();
+                if (contiguous.data())
+                    std::copy_n(contiguous.data() + index, count, out);
+                else
+                    for (size_t i = 0; i < count; i++)
+                        out[i] = elements->get(static_cast<int>(index + i));
+            }
+
+            index += count;
+            return count;
+        };
+    }
+
+    SizeHint size_hint() const override
+    {
+        size_t size = static_cast<size_t>(source->get_size());
+        return SizeHint::exact(size - std::min(size, current_index));
     }
 
     bool has_next() override
     {
-        return current_index < sequence.get_size();
+        return current_index < static_cast<size_t>(source->get_size());
     }
 };
 
 template <typename T>
-class Concat_Generator : public Generator<T>
+class Concat_Generator : public Pull_Generator<T>
 {
 private:
     std::shared_ptr<LazySequence<T>> first;
     std::shared_ptr<LazySequence<T>> second;
 
-    size_t first_index;
-    size_t second_index;
-
 public:
     Concat_Generator(
         std::shared_ptr<LazySequence<T>> first_seq,
         std::shared_ptr<LazySequence<T>> second_seq)
         : first(first_seq),
-          second(second_seq),
-          first_index(0),
-          second_index(0)
+          second(second_seq)
     {}
 
-    T get_next() override
+    SizeHint total_hint() const override
     {
-        bool can_use_first =
-            first->has_next() || first_index < first->get_materialized_count();
-
-        bool can_use_second =
-            second->has_next() || second_index < second->get_materialized_count();
-
-        if (can_use_first)
-            return first->get(first_index++);
-
-        if (can_use_second)
-            return second->get(second_index++);
-
-        throw std::runtime_error("Generation limit reached");
+        return first->size_hint() + second->size_hint();
     }
 
-    bool has_next() override
+    void release_upstreams() override
     {
-        bool can_use_first =
-            first->has_next() || first_index < first->get_materialized_count();
+        first.reset();
+        second.reset();
+    }
 
-        bool can_use_second =
-            second->has_next() || second_index < second->get_materialized_count();
+    // The first part is dropped once it runs dry.
+    Batch_Source<T> fork() const override
+    {
+        if (!first)
+            return nullptr;
 
-        return can_use_first || can_use_second;
+        return [first = first->fork(), second = second->fork()]
+            (T* out, size_t max) mutable -> size_t {
+            if (first)
+            {
+                if (size_t count = first(out, max))
+                    return count;
+                first = nullptr;
+            }
+            return second(out, max);
+        };
     }
 };
 
+// Emits one element of secondary at position insert_index of primary, or
+// primary alone when secondary is empty or primary ends before that point.
 template <typename T>
-class Insert_Generator : public Generator<T>
+class Insert_Generator : public Pull_Generator<T>
 {
 private:
     std::shared_ptr<LazySequence<T>> primary;
     std::shared_ptr<LazySequence<T>> secondary;
-
-    size_t primary_index;
-    size_t secondary_index;
-    size_t current_index;
     size_t insert_index;
 
 public:
@@ -158,52 +595,74 @@ public:
         size_t insert_index)
         : primary(primary_seq),
           secondary(secondary_seq),
-          primary_index(0),
-          secondary_index(0),
-          current_index(0),
           insert_index(insert_index)
     {}
 
-    T get_next() override
+    // secondary contributes one element if primary reaches insert_index
+    SizeHint total_hint() const override
     {
-        bool can_use_primary =
-            primary->has_next() || primary_index < primary->get_materialized_count();
+        SizeHint main = primary->size_hint();
+        SizeHint extra = SizeHint::at_most(1);
+        SizeHint inserted = secondary->size_hint();
 
-        bool can_use_secondary =
-            secondary->has_next() || secondary_index < secondary->get_materialized_count();
+        if ((inserted.is_exact() && inserted.value == 0)
+            || (main.is_known() && main.value < insert_index))
+            extra = SizeHint::exact(0);
+        else if (inserted.is_exact() && main.is_exact())
+            extra = SizeHint::exact(1);
 
-        if (current_index == insert_index && can_use_secondary)
-        {
-            ++current_index;
-            return secondary->get(secondary_index++);
-        }
-
-        ++current_index;
-
-        if (can_use_primary)
-            return primary->get(primary_index++);
+        return main + extra;
+    }
 
-        throw std::runtime_error("Generation limit reached");
+    void release_upstreams() override
+    {
+        primary.reset();
+        secondary.reset();
     }
 
-    bool has_next() override
+    // secondary is only asked once, and dropped after that.
+    Batch_Source<T> fork() const override
     {
-        bool can_use_primary =
-            primary->has_next() || primary_index < primary->get_materialized_count();
+        if (!primary)
+            return nullptr;
+
+        return [primary = primary->fork(), secondary = secondary->fork(),
+                insert_index = insert_index, current_index = size_t(0)]
+            (T* out, size_t max) mutable -> size_t {
+            if (max == 0)
+                return 0;
+
+            if (secondary && current_index == insert_index)
+            {
+                size_t inserted = secondary(out, 1);
+                secondary = nullptr;
+
+                if (inserted == 1)
+                {
+                    ++current_index;
+                    return 1;
+                }
+            }
 
-        bool can_use_secondary =
-            secondary->has_next() || secondary_index < secondary->get_materialized_count();
+            // primary elements up to the insertion point, or to the end
+            size_t wanted = max;
+            if (current_index < insert_index)
+                wanted = std::min(wanted, insert_index - current_index);
 
-        return can_use_primary || can_use_secondary;
+            size_t count = primary(out, wanted);
+            current_index += count;
+            return count;
+        };
     }
 };
 
+// Elements from_index..to_index of the upstream. The part before
+// from_index is skipped, so a random-access upstream never produces it.
 template <typename T>
-class Subsequence_Generator : public Generator<T>
+class Subsequence_Generator : public Pull_Generator<T>
 {
 private:
     std::shared_ptr<LazySequence<T>> sequence;
-    size_t current_index;
     size_t from_index;
     size_t to_index;
 
@@ -213,36 +672,51 @@ public:
         size_t from,
         size_t to)
         : sequence(seq),
-          current_index(from),
           from_index(from),
           to_index(to)
     {}
 
-    T get_next() override
+    SizeHint total_hint() const override
     {
-        if (has_next())
-            return sequence->get(current_index++);
-
-        throw std::runtime_error("Generation limit reached");
+        size_t length = to_index >= from_index ? to_index - from_index + 1 : 0;
+        return sequence->size_hint().after(from_index).capped(length);
     }
 
-    bool has_next() override
+    Batch_Source<T> fork() const override
     {
-        bool can_use_seq =
-            sequence->has_next() || current_index < sequence->get_materialized_count();
+        size_t length = to_index >= from_index ? to_index - from_index + 1 : 0;
 
-        return current_index >= from_index &&
-               current_index <= to_index &&
-               can_use_seq;
+        return [upstream = sequence->fork(), to_skip = from_index, remaining = length]
+            (T* out, size_t max) mutable -> size_t {
+            if (remaining == 0)
+                return 0;
+
+            while (to_skip > 0)
+            {
+                size_t skipped = upstream(nullptr, to_skip);
+                if (skipped == 0)
+                    return 0;
+                to_skip -= skipped;
+            }
+
+            size_t count = upstream(out, std::min(max, remaining));
+            remaining -= count;
+            return count;
+        };
     }
 };
 
+// Pulls from a fork of its upstream, so consecutive map/where stages run
+// as one loop over the first cached or non-stateless sequence below them.
+// Skipping passes straight through: func is only called on elements that
+// are produced.
 template <typename TOut, typename TIn>
-class Map_Generator : public Generator<TOut>
+class Map_Generator : public Pull_Generator<TOut>
 {
 private:
+    static constexpr size_t block_size = 1024;
+
     std::shared_ptr<LazySequence<TIn>> sequence;
-    size_t current_index;
     std::function<TOut(TIn)> func;
 
 public:
@@ -250,73 +724,177 @@ public:
         std::shared_ptr<LazySequence<TIn>> seq,
         std::function<TOut(TIn)> func)
         : sequence(seq),
-          current_index(0),
           func(func)
     {}
 
-    TOut get_next() override
+    SizeHint total_hint() const override
     {
-        if (has_next())
-            return func(sequence->get(current_index++));
+        return sequence->size_hint();
+    }
 
-        throw std::runtime_error("Generation limit reached");
+    Batch_Source<TOut> fork() const override
+    {
+        return [upstream = sequence->fork(), func = func, block = DynamicArray<TIn>()]
+            (TOut* out, size_t max) mutable -> size_t {
+            if (!out)
+                return upstream(nullptr, max);
+
+            size_t wanted = std::min(max, block_size);
+            if (static_cast<size_t>(block.get_size()) < wanted)
+                block.resize(static_cast<int>(wanted));
+
+            size_t pulled = upstream(block.get_data(), wanted);
+            for (size_t i = 0; i < pulled; i++)
+                out[i] = func(block[static_cast<int>(i)]);
+            return pulled;
+        };
     }
+};
 
-    bool has_next() override
+// Map_Generator that evaluates func on a thread pool, so func must be safe
+// to call concurrently. Inputs are pulled lookahead at a time and their
+// results are kept until read, in input order; a request for at least
+// lookahead elements is computed straight into the caller's buffer. So
+// at most lookahead elements are evaluated beyond what has been asked for,
+// and skipped elements are still never evaluated.
+template <typename TOut, typename TIn>
+class Parallel_Map_Generator : public Pull_Generator<TOut>
+{
+private:
+    std::shared_ptr<LazySequence<TIn>> sequence;
+    std::function<TOut(TIn)> func;
+    size_t lookahead;
+    ThreadPool* pool;
+
+public:
+    Parallel_Map_Generator(
+        std::shared_ptr<LazySequence<TIn>> seq,
+        std::function<TOut(TIn)> func,
+        size_t lookahead,
+        ThreadPool& pool)
+        : sequence(seq),
+          func(func),
+          lookahead(std::max<size_t>(lookahead, 1)),
+          pool(&pool)
+    {}
+
+    SizeHint total_hint() const override
     {
-        return sequence->has_next() ||
-               current_index < sequence->get_materialized_count();
+        return sequence->size_hint();
+    }
+
+    Batch_Source<TOut> fork() const override
+    {
+        return [upstream = sequence->fork(), func = func, lookahead = lookahead, pool = pool,
+                inputs = DynamicArray<TIn>(), results = DynamicArray<TOut>(),
+                position = size_t(0), ready = size_t(0)]
+            (TOut* out, size_t max) mutable -> size_t {
+            if (position == ready)
+            {
+                if (!out)
+                    return upstream(nullptr, max);
+
+                if (static_cast<size_t>(inputs.get_size()) < lookahead)
+                    inputs.resize(static_cast<int>(lookahead));
+
+                size_t pulled = upstream(inputs.get_data(), lookahead);
+                if (pulled == 0)
+                    return 0;
+
+                TOut* target = out;
+                if (max < pulled)
+                {
+                    if (static_cast<size_t>(results.get_size()) < lookahead)
+                        results.resize(static_cast<int>(lookahead));
+                    target = results.get_data();
+                }
+
+                const TIn* items = inputs.get_data();
+                pool->parallel_for(pulled, 1, [&](size_t, size_t begin, size_t end) {
+                    for (size_t i = begin; i < end; i++)
+                        target[i] = func(items[i]);
+                });
+
+                if (target == out)
+                    return pulled;
+
+                position = 0;
+                ready = pulled;
+            }
+
+            size_t count = std::min(max, ready - position);
+            if (out)
+                std::move(results.get_data() + position, results.get_data() + position + count, out);
+            position += count;
+            return count;
+        };
     }
 };
 
 template <typename T>
-class Where_Generator : public Generator<T>
+class Where_Generator : public Pull_Generator<T>
 {
 private:
+    static constexpr size_t block_size = 1024;
+
     std::shared_ptr<LazySequence<T>> sequence;
-    size_t current_index;
-    std::optional<T> cached_item;
     std::function<bool(T)> func;
 
+    // Every input yields at most one output, so asking upstream for the
+    // number of outputs still missing never reads past what is needed.
+    // Survivors are compacted in place.
+    static size_t filter(Batch_Source<T>& upstream, std::function<bool(T)>& func,
+                         T* out, size_t max)
+    {
+        size_t count = 0;
+        while (count < max)
+        {
+            size_t pulled = upstream(out + count, max - count);
+            if (pulled == 0)
+                break;
+
+            size_t end = count + pulled;
+            for (size_t i = count; i < end; i++)
+            {
+                if (func(out[i]))
+                {
+                    if (i != count)
+                        out[count] = std::move(out[i]);
+                    ++count;
+                }
+            }
+        }
+
+        return count;
+    }
+
 public:
     Where_Generator(
         std::shared_ptr<LazySequence<T>> seq,
         std::function<bool(T)> func)
         : sequence(seq),
-          current_index(0),
-          cached_item(std::nullopt),
           func(func)
     {}
 
-    T get_next() override
+    SizeHint total_hint() const override
     {
-        if (has_next())
-        {
-            T result = *cached_item;
-            cached_item.reset();
-            return result;
-        }
-
-        throw std::runtime_error("Generation limit reached");
+        return sequence->size_hint().loosened();
     }
 
-    bool has_next() override
+    // Skipping still has to test every element, in a scratch block.
+    Batch_Source<T> fork() const override
     {
-        if (cached_item.has_value())
-            return true;
+        return [upstream = sequence->fork(), func = func, block = DynamicArray<T>()]
+            (T* out, size_t max) mutable -> size_t {
+            if (out)
+                return filter(upstream, func, out, max);
 
-        while (sequence->has_next() ||
-               current_index < sequence->get_materialized_count())
-        {
-            T item = sequence->get(current_index++);
-            if (func(item))
-            {
-                cached_item = item;
-                return true;
-            }
-        }
+            size_t wanted = std::min(max, block_size);
+            if (static_cast<size_t>(block.get_size()) < wanted)
+                block.resize(static_cast<int>(wanted));
 
-        return false;
+            return filter(upstream, func, block.get_data(), wanted);
+        };
     }
 };
 
@@ -327,10 +905,31 @@ private:
     std::istream* in;
     bool finished;
 
+    // Bytes left in a seekable stream when it was handed over. Only a
+    // bound: text-mode newline translation may read fewer characters.
+    SizeHint length;
+    size_t consumed;
+
 public:
     explicit Stream_Generator(std::istream& input)
-        : in(&input), finished(false)
-    {}
+        : in(&input), finished(false), length(SizeHint::unknown()), consumed(0)
+    {
+        std::istream::pos_type start = in->tellg();
+        if (start == std::istream::pos_type(-1))
+            return;
+
+        in->seekg(0, std::ios::end);
+        std::istream::pos_type end = in->tellg();
+        in->seekg(start);
+
+        if (end != std::istream::pos_type(-1) && end >= start)
+            length = SizeHint::at_most(static_cast<size_t>(end - start));
+    }
+
+    SizeHint size_hint() const override
+    {
+        return finished ? SizeHint::exact(0) : length.after(consumed);
+    }
 
     bool has_next() override
     {
@@ -353,12 +952,240 @@ public:
 
         T value;
         in->get(value);
+        ++consumed;
 
         if (!(*in))
             finished = true;
 
         return value;
     }
+
+    size_t next_batch(T* out, size_t max) override
+    {
+        if (finished || max == 0)
+            return 0;
+
+        in->read(out, static_cast<std::streamsize>(max));
+        size_t count = static_cast<size_t>(in->gcount());
+        consumed += count;
+
+        if (count < max)
+            finished = true;
+
+        return count;
+    }
+};
+
+// Runs upstream on a producer thread that stays up to capacity elements
+// ahead of the reader. The two threads share a single-producer
+// single-consumer ring: each side only advances its own index, so neither
+// takes a lock while the other keeps up. A side with nothing to do spins
+// briefly and then blocks until the other catches up, so an idle prefetched
+// sequence costs no CPU. A full ring stops the producer, so an infinite
+// upstream costs capacity elements, not memory without bound.
+//
+// upstream then runs on another thread than the reader, so it must not
+// read anything the reader's thread uses: a stream, a recurrence or a
+// chain over array sources is fine, a stage over a LazySequence that is
+// also read directly is not. An exception in upstream is rethrown to the
+// reader once it has read everything produced before it.
+template <typename T>
+class Prefetch_Generator : public Generator<T>
+{
+private:
+    static constexpr size_t producer_batch = 4096;
+
+    std::unique_ptr<Generator<T>> upstream;
+    DynamicArray<T> ring;
+    size_t capacity;
+
+    // head is written by the reader only, tail by the producer only; both
+    // grow without wrapping and index the ring modulo capacity
+    alignas(64) std::atomic<size_t> head;
+    alignas(64) std::atomic<size_t> tail;
+    std::atomic<bool> finished;
+    std::atomic<bool> stopping;
+    std::exception_ptr failure;
+
+    // A side that still cannot go on after spinning parks on its condition
+    // variable; the other side notifies it only while its flag is set, so
+    // the fast path takes no lock.
+    static constexpr int spin_rounds = 64;
+    std::mutex park_mutex;
+    std::condition_variable producer_wakeup;
+    std::condition_variable reader_wakeup;
+    std::atomic<bool> producer_parked;
+    std::atomic<bool> reader_parked;
+
+    std::thread producer;
+
+    template <typename Ready>
+    void park_until(std::atomic<bool>& parked, std::condition_variable& wakeup, Ready ready)
+    {
+        for (int round = 0; round < spin_rounds; round++)
+        {
+            if (ready())
+                return;
+            std::this_thread::yield();
+        }
+
+        std::unique_lock<std::mutex> lock(park_mutex);
+        parked.store(true, std::memory_order_relaxed);
+        // pairs with the fence in wake(): either ready() sees the other
+        // side's progress or the other side sees the flag
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        wakeup.wait(lock, ready);
+        parked.store(false, std::memory_order_relaxed);
+    }
+
+    // Called after publishing progress that may make the other side ready.
+    void wake(std::atomic<bool>& parked, std::condition_variable& wakeup)
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (parked.load(std::memory_order_relaxed))
+        {
+            std::lock_guard<std::mutex> lock(park_mutex);
+            wakeup.notify_one();
+        }
+    }
+
+    bool ring_has_room(size_t end) const
+    {
+        return end - head.load(std::memory_order_acquire) < capacity
+            || stopping.load(std::memory_order_relaxed);
+    }
+
+    void produce()
+    {
+        try
+        {
+            T* items = ring.get_data();
+            size_t end = 0;
+
+            while (!stopping.load(std::memory_order_relaxed))
+            {
+                if (!ring_has_room(end))
+                {
+                    park_until(producer_parked, producer_wakeup, [&] { return ring_has_room(end); });
+                    continue;
+                }
+
+                size_t room = capacity - (end - head.load(std::memory_order_acquire));
+
+                size_t offset = end % capacity;
+                size_t wanted = std::min({ room, capacity - offset, producer_batch });
+
+                size_t produced = upstream->next_batch(items + offset, wanted);
+                if (produced == 0)
+                    break;
+
+                end += produced;
+                tail.store(end, std::memory_order_release);
+                wake(reader_parked, reader_wakeup);
+            }
+        }
+        catch (...)
+        {
+            failure = std::current_exception();
+        }
+
+        finished.store(true, std::memory_order_release);
+        wake(reader_parked, reader_wakeup);
+    }
+
+    // Elements ready to read, waiting for the producer while there are
+    // none and it is still running.
+    size_t wait_for_items()
+    {
+        size_t begin = head.load(std::memory_order_relaxed);
+        while (true)
+        {
+            // finished is read before tail, so a producer that ended in
+            // between still has its last elements seen
+            bool done = finished.load(std::memory_order_acquire);
+            size_t available = tail.load(std::memory_order_acquire) - begin;
+
+            if (available > 0)
+                return available;
+            if (done)
+            {
+                if (failure)
+                    std::rethrow_exception(std::exchange(failure, nullptr));
+                return 0;
+            }
+
+            park_until(reader_parked, reader_wakeup, [&] {
+                return finished.load(std::memory_order_acquire)
+                    || tail.load(std::memory_order_acquire) != begin;
+            });
+        }
+    }
+
+public:
+    Prefetch_Generator(std::unique_ptr<Generator<T>> upstream, size_t capacity)
+        : upstream(std::move(upstream)),
+          ring(static_cast<int>(std::max<size_t>(capacity, 1))),
+          capacity(std::max<size_t>(capacity, 1)),
+          head(0),
+          tail(0),
+          finished(false),
+          stopping(false),
+          producer_parked(false),
+          reader_parked(false)
+    {
+        producer = std::thread([this] { produce(); });
+    }
+
+    ~Prefetch_Generator() override
+    {
+        stopping.store(true, std::memory_order_relaxed);
+        wake(producer_parked, producer_wakeup);
+        producer.join();
+    }
+
+    T get_next() override
+    {
+        if (!has_next())
+            throw std::runtime_error("Generation limit reached");
+
+        size_t begin = head.load(std::memory_order_relaxed);
+        T result = std::move(ring.get_data()[begin % capacity]);
+        head.store(begin + 1, std::memory_order_release);
+        wake(producer_parked, producer_wakeup);
+        return result;
+    }
+
+    bool has_next() override
+    {
+        return wait_for_items() > 0;
+    }
+
+    size_t next_batch(T* out, size_t max) override
+    {
+        size_t count = 0;
+        while (count < max)
+        {
+            // everything the producer has published, unless the reader
+            // already has some and would have to wait for more
+            if (count > 0 && tail.load(std::memory_order_acquire) == head.load(std::memory_order_relaxed))
+                break;
+
+            size_t available = wait_for_items();
+            if (available == 0)
+                break;
+
+            size_t begin = head.load(std::memory_order_relaxed);
+            size_t offset = begin % capacity;
+            size_t taken = std::min({ available, capacity - offset, max - count });
+
+            std::move(ring.get_data() + offset, ring.get_data() + offset + taken, out + count);
+            head.store(begin + taken, std::memory_order_release);
+            wake(producer_parked, producer_wakeup);
+            count += taken;
+        }
+
+        return count;
+    }
 };
 
 #include "LazySequence.hpp"
\ No newline at end of file
@@ -0,0 +1,310 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "ArraySequence.hpp"
+#include "Generator.hpp"
+#include "LazySequence.hpp"
+
+// Statically typed counterpart of LazySequence's map/where chains. Every
+// stage keeps its callable by value and is part of the pipeline's type, so
+// the whole chain inlines into one loop over the source: elements are pushed
+// through the stages, and a stage returns false to stop the loop.
+//
+// A pipeline is a single pass. next() and the terminal operations consume
+// it from where it stands; copy a pipeline to run it again. erase() wraps it
+// into a LazySequence when a type-erased handle is needed.
+
+// Elements of an ArraySequence, held by a copy-on-write copy, so building a
+// pipeline is O(1) and the source may change or die afterwards.
+template <typename T>
+class Array_Source
+{
+private:
+    ArraySequence<T> items;
+    size_t position;
+
+public:
+    using value_type = T;
+
+    explicit Array_Source(const ArraySequence<T>& seq)
+        : items(seq, seq.get_memory_resource()), position(0)
+    {}
+
+    template <typename Sink>
+    bool push_all(Sink&& sink)
+    {
+        Span<const T> span = items.as_span();
+        const T* data = span.data();
+        size_t size = span.size();
+
+        for (size_t i = position; i < size; i++)
+        {
+            if (!sink(data[i]))
+            {
+                position = i + 1;
+                return false;
+            }
+        }
+
+        position = size;
+        return true;
+    }
+};
+
+template <typename F>
+struct Map_Stage
+{
+    F func;
+
+    template <typename In>
+    using output = std::decay_t<std::invoke_result_t<F&, const In&>>;
+
+    template <typename In, typename Next>
+    bool push(const In& item, Next&& next)
+    {
+        return next(func(item));
+    }
+};
+
+template <typename P>
+struct Where_Stage
+{
+    P predicate;
+
+    template <typename In>
+    using output = In;
+
+    template <typename In, typename Next>
+    bool push(const In& item, Next&& next)
+    {
+        return predicate(item) ? next(item) : true;
+    }
+};
+
+template <typename In, typename... Stages>
+struct Pipeline_Output
+{
+    using type = In;
+};
+
+template <typename In, typename Stage, typename... Rest>
+struct Pipeline_Output<In, Stage, Rest...>
+{
+    using type = typename Pipeline_Output<typename Stage::template output<In>, Rest...>::type;
+};
+
+template <typename Source, typename... Stages>
+class LazyPipeline
+{
+    template <typename, typename...> friend class LazyPipeline;
+
+private:
+    Source source;
+    std::tuple<Stages...> stages;
+
+    template <size_t I, typename In, typename Sink>
+    bool push(const In& item, Sink& sink)
+    {
+        if constexpr (I == sizeof...(Stages))
+            return sink(item);
+        else
+            return std::get<I>(stages).push(item, [this, &sink](const auto& out) {
+                return this->template push<I + 1>(out, sink);
+            });
+    }
+
+    template <typename Sink>
+    bool run(Sink&& sink)
+    {
+        return source.push_all([this, &sink](const auto& item) {
+            return this->template push<0>(item, sink);
+        });
+    }
+
+    template <typename Stage>
+    LazyPipeline<Source, Stages..., Stage> then(Stage stage) const
+    {
+        return LazyPipeline<Source, Stages..., Stage>(
+            source, std::tuple_cat(stages, std::make_tuple(std::move(stage))));
+    }
+
+public:
+    using value_type = typename Pipeline_Output<typename Source::value_type, Stages...>::type;
+
+    LazyPipeline(Source source, std::tuple<Stages...> stages)
+        : source(std::move(source)), stages(std::move(stages))
+    {}
+
+    template <typename F>
+    auto map(F func) const
+    {
+        return then(Map_Stage<F>{ std::move(func) });
+    }
+
+    template <typename P>
+    auto where(P predicate) const
+    {
+        return then(Where_Stage<P>{ std::move(predicate) });
+    }
+
+    // Pulls the next element; false once the pipeline is exhausted.
+    bool next(value_type& out)
+    {
+        bool produced = false;
+        run([&](const value_type& item) {
+            out = item;
+            produced = true;
+            return false;
+        });
+        return produced;
+    }
+
+    // Pulls up to max elements into out, with the contract of
+    // Batch_Source; a null out only counts them.
+    size_t next_batch(value_type* out, size_t max)
+    {
+        size_t count = 0;
+        if (max == 0)
+            return 0;
+
+        run([&](const value_type& item) {
+            if (out)
+                out[count] = item;
+            return ++count < max;
+        });
+        return count;
+    }
+
+    template <typename F>
+    void for_each(F&& func)
+    {
+        run([&](const value_type& item) {
+            func(item);
+            return true;
+        });
+    }
+
+    template <typename U, typename Op>
+    U reduce(U initial, Op&& op)
+    {
+        run([&](const value_type& item) {
+            initial = op(std::move(initial), item);
+            return true;
+        });
+        return initial;
+    }
+
+    value_type sum()
+    {
+        return reduce(value_type(), [](value_type total, const value_type& item) {
+            return total + item;
+        });
+    }
+
+    size_t count()
+    {
+        size_t total = 0;
+        run([&](const value_type&) {
+            ++total;
+            return true;
+        });
+        return total;
+    }
+
+    ArraySequence<value_type> to_array(std::pmr::memory_resource* resource = nullptr)
+    {
+        ArraySequence<value_type> result(resource);
+        run([&](const value_type& item) {
+            result.append(item);
+            return true;
+        });
+        return result;
+    }
+
+    std::shared_ptr<LazySequence<value_type>> erase(
+        std::pmr::memory_resource* resource = nullptr) const;
+};
+
+template <typename T>
+LazyPipeline<Array_Source<T>> make_pipeline(const ArraySequence<T>& seq)
+{
+    return LazyPipeline<Array_Source<T>>(Array_Source<T>(seq), std::tuple<>());
+}
+
+// Runs a pipeline behind the Generator interface. It keeps a copy of the
+// pipeline as it was handed over, so LazySequence stages built on top can
+// fork it and pull straight from the source.
+template <typename Pipeline>
+class Pipeline_Generator : public Generator<typename Pipeline::value_type>
+{
+private:
+    using T = typename Pipeline::value_type;
+
+    Pipeline origin;
+    Pipeline running;
+    std::optional<T> pending;
+
+public:
+    explicit Pipeline_Generator(const Pipeline& pipeline)
+        : origin(pipeline), running(pipeline), pending(std::nullopt)
+    {}
+
+    T get_next() override
+    {
+        if (!has_next())
+            throw std::runtime_error("Generation limit reached");
+
+        T result = std::move(*pending);
+        pending.reset();
+        return result;
+    }
+
+    bool has_next() override
+    {
+        if (pending.has_value())
+            return true;
+
+        T item;
+        if (!running.next(item))
+            return false;
+
+        pending = std::move(item);
+        return true;
+    }
+
+    size_t next_batch(T* out, size_t max) override
+    {
+        size_t count = 0;
+        if (max > 0 && pending.has_value())
+        {
+            out[count++] = std::move(*pending);
+            pending.reset();
+        }
+
+        return count + running.next_batch(out + count, max - count);
+    }
+
+    Batch_Source<T> fork() const override
+    {
+        return [pipeline = origin](T* out, size_t max) mutable {
+            return pipeline.next_batch(out, max);
+        };
+    }
+};
+
+template <typename Source, typename... Stages>
+std::shared_ptr<LazySequence<typename LazyPipeline<Source, Stages...>::value_type>>
+LazyPipeline<Source, Stages...>::erase(std::pmr::memory_resource* resource) const
+{
+    return LazySequence<value_type>::create(
+        std::make_unique<Pipeline_Generator<LazyPipeline<Source, Stages...>>>(*this),
+        resource
+    );
+}
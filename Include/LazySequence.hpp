@@ -1,62 +1,196 @@
 #pragma once
 
+#include <algorithm>
 #include <memory>
+#include <memory_resource>
 #include <functional>
+#include <optional>
 #include <stdexcept>
+#include <utility>
 
 template <typename T>
 class Generator; 
 
 #include "Sequence.hpp"
 #include "ArraySequence.hpp"
+#include "SizeHint.hpp"
+#include "ThreadPool.hpp"
 
+// How much of its generated prefix a LazySequence keeps. Indices never
+// shift: asking for a released element throws.
+//  - unbounded: everything, forever (the default);
+//  - sliding_window(n): the last n elements, plus whatever the current
+//    request generates;
+//  - release_below_cursor: nothing below the lowest index the single
+//    forward-only reader may still ask for, i.e. its last get/materialize.
+struct RetentionPolicy
+{
+    enum class Mode { unbounded, sliding_window, release_below_cursor };
+
+    Mode mode;
+    size_t window;
+
+    static RetentionPolicy unbounded()
+    {
+        return { Mode::unbounded, 0 };
+    }
+
+    static RetentionPolicy sliding_window(size_t window)
+    {
+        if (window == 0)
+            throw std::invalid_argument("Retention window must not be empty");
+        return { Mode::sliding_window, window };
+    }
+
+    static RetentionPolicy release_below_cursor()
+    {
+        return { Mode::release_below_cursor, 0 };
+    }
+};
+
+// Every stage derived from a sequence (map, where, append, ...) allocates its
+// cache and its own control block from the same memory resource, so a whole
+// pipeline can live in one arena. The resource must outlive every stage.
 template <typename T>
 class LazySequence : public std::enable_shared_from_this<LazySequence<T>>
 {
+    template <typename> friend class LazySequence;
+
 private:
+    std::pmr::memory_resource* resource;
     std::unique_ptr<Generator<T>> generator;
-    std::unique_ptr<ArraySequence<T>> materialized_data;
+    ArraySequence<T> materialized_data;
+
+    // materialized_data holds elements [erased, erased + size). Elements
+    // below released are no longer readable; they are erased in bulk once
+    // they outweigh the rest, which keeps releasing cheap per element.
+    static constexpr size_t release_slack = 64;
+    RetentionPolicy retention;
+    size_t erased;
+    size_t released;
+    size_t cursor;
+
+    // Further than this past the materialized prefix, get() asks a
+    // generator that can jump for the element instead of generating up to it.
+    static constexpr size_t jump_distance = 4096;
+
+    // Generators fill this block and it is appended to materialized_data in
+    // one go; the block size bounds the scratch space, not the request.
+    static constexpr size_t batch_size = 1024;
+    DynamicArray<T> batch;
+
+    void generate_until(size_t count);
+    void reserve_for(size_t count);
+    void advance_released();
+    void release_retired();
+    void check_retained(size_t index);
+    void release_drained(size_t count);
+
+    template <typename F>
+    bool drain(F&& visit);
+
+    template <typename... Args>
+    static std::shared_ptr<LazySequence<T>> allocate(
+        std::pmr::memory_resource* resource,
+        Args&&... args
+    );
 
     void init_function_generator(
         size_t arity,
-        std::function<T(const Sequence<T>&)> rule
+        std::function<T(const ArraySequence<T>&)> rule
     );
 
 public:
-    LazySequence();
+    explicit LazySequence(std::pmr::memory_resource* resource = nullptr);
 
     LazySequence(
         const Sequence<T>& start_sequence,
         size_t arity,
-        std::function<T(const Sequence<T>&)> rule
+        std::function<T(const Sequence<T>&)> rule,
+        std::pmr::memory_resource* resource = nullptr
     );
 
-    explicit LazySequence(const Sequence<T>& sequence);
-    explicit LazySequence(std::unique_ptr<Generator<T>>&& gen);
+    explicit LazySequence(
+        const Sequence<T>& sequence,
+        std::pmr::memory_resource* resource = nullptr
+    );
+
+    explicit LazySequence(
+        std::unique_ptr<Generator<T>>&& gen,
+        std::pmr::memory_resource* resource = nullptr
+    );
 
-    static std::shared_ptr<LazySequence<T>> create();
+    static std::shared_ptr<LazySequence<T>> create(
+        std::pmr::memory_resource* resource = nullptr
+    );
 
     static std::shared_ptr<LazySequence<T>> create(
         const Sequence<T>& start_sequence,
         size_t arity,
-        std::function<T(const ArraySequence<T>&)> rule
+        std::function<T(const ArraySequence<T>&)> rule,
+        std::pmr::memory_resource* resource = nullptr
     );
 
     static std::shared_ptr<LazySequence<T>> create(
-        std::unique_ptr<Generator<T>>&& gen
+        std::unique_ptr<Generator<T>>&& gen,
+        std::pmr::memory_resource* resource = nullptr
     );
 
     static std::shared_ptr<LazySequence<T>> create(
-        const Sequence<T>& sequence
+        const Sequence<T>& sequence,
+        std::pmr::memory_resource* resource = nullptr
     );
 
+    // Linear recurrence over the last coefficients.get_size() elements; see
+    // Linear_Recurrence_Generator. Far indices are computed directly and not
+    // cached.
+    static std::shared_ptr<LazySequence<T>> create_linear(
+        const Sequence<T>& start_sequence,
+        const Sequence<T>& coefficients,
+        std::pmr::memory_resource* resource = nullptr
+    );
+
+    std::pmr::memory_resource* get_memory_resource() const;
+
     T get(size_t index);
     T get_next();
 
+    // Generates up to index from + count - 1 and returns the materialized
+    // part of [from, from + count); shorter only if generation ran out. The
+    // span is invalidated by the next call that generates.
+    Span<const T> materialize(size_t from, size_t count);
+
+    // Independent source of this sequence's elements from the first one on.
+    // While nothing has been cached yet and the generator is stateless, it
+    // bypasses this sequence entirely, so stages built on top of an
+    // intermediate map/where do not make it cache anything. Stages fork on
+    // their first pull, so an intermediate read before that is reused; one
+    // read only afterwards computes its elements a second time. A skip that
+    // reaches past the cache moves to such a source as well, so it does not
+    // cache the elements it passes over.
+    std::function<size_t(T*, size_t)> fork();
+
     T get_first_materialized() const;
     T get_last_materialized() const;
+
+    // Counts released elements too, so it is also the next index to generate.
     size_t get_materialized_count() const;
 
+    // Length of the whole sequence as far as the generator chain can tell.
+    // size() returns it once it is exact, without generating anything.
+    SizeHint size_hint() const;
+    std::optional<size_t> size() const;
+    size_t get_released_count() const;
+
+    void set_retention(RetentionPolicy policy);
+    RetentionPolicy get_retention() const;
+
+    // Moves the generator onto a producer thread that runs up to capacity
+    // elements ahead of the readers; see Prefetch_Generator for what the
+    // generator may touch. Far indices are no longer jumped to.
+    static constexpr size_t default_prefetch_capacity = size_t(1) << 16;
+    void prefetch(size_t capacity = default_prefetch_capacity);
+
     bool has_next() const;
 
     std::shared_ptr<LazySequence<T>> append(
@@ -82,6 +216,15 @@ public:
         std::function<T2(const T&)> func
     );
 
+    // map evaluated on pool, up to lookahead elements ahead of the reader;
+    // see Parallel_Map_Generator.
+    template <typename T2>
+    std::shared_ptr<LazySequence<T2>> map_parallel(
+        std::function<T2(const T&)> func,
+        size_t lookahead = 1024,
+        ThreadPool& pool = ThreadPool::get_default()
+    );
+
     std::shared_ptr<LazySequence<T>> where(
         std::function<bool(T)> func
     );
@@ -89,6 +232,34 @@ public:
     std::shared_ptr<LazySequence<T>> set_generator(
         std::unique_ptr<Generator<T>> generator
     );
+
+    // Terminal operations: they visit every element once, in blocks, and
+    // cache nothing. A stateless generator chain is read through a fork,
+    // so the sequence itself is left as it was. Otherwise the generator is
+    // drained and the sequence is used up: everything it held or produced
+    // counts as released. A chain over such a sequence reads it through its
+    // cache, so give that sequence a releasing retention policy to keep the
+    // whole run in constant memory.
+    template <typename U, typename Op>
+    U fold(U initial, Op&& op);
+
+    // fold seeded with the first element; throws on an empty sequence.
+    template <typename Op>
+    T reduce(Op&& op);
+
+    size_t count();
+    T sum();
+    T min();
+    T max();
+
+    template <typename P>
+    bool any_of(P&& predicate);
+
+    template <typename P>
+    bool all_of(P&& predicate);
+
+    template <typename F>
+    void for_each(F&& func);
 };
 
 #include "../src/LazySequence.inl"
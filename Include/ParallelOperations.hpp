@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+#include "ArraySequence.hpp"
+#include "DynamicArray.hpp"
+#include "ThreadPool.hpp"
+
+// Data-parallel counterparts of ArraySequence::map and friends. Work is split
+// into one contiguous chunk per pool thread and every chunk writes straight
+// into pre-sized output storage. Chunks smaller than min_chunk are not worth
+// a thread hop and are merged.
+
+constexpr size_t parallel_min_chunk = 4096;
+
+template <typename T, typename F>
+auto parallel_map(
+    const ArraySequence<T>& seq,
+    F&& func,
+    ThreadPool& pool = ThreadPool::get_default())
+    -> ArraySequence<std::decay_t<std::invoke_result_t<F&, const T&>>>
+{
+    using U = std::decay_t<std::invoke_result_t<F&, const T&>>;
+
+    Span<const T> input = seq.as_span();
+    ArraySequence<U> result(static_cast<int>(input.size()), seq.get_memory_resource());
+    Span<U> output(result.get_data(), input.size());
+
+    pool.parallel_for(input.size(), parallel_min_chunk,
+        [&](size_t, size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i)
+                output[i] = func(input[i]);
+        });
+
+    return result;
+}
+
+// Stable: kept elements stay in their original order. The predicate runs
+// once per element; a prefix sum over per-chunk counts tells every chunk
+// where its survivors go.
+template <typename T, typename P>
+ArraySequence<T> parallel_where(
+    const ArraySequence<T>& seq,
+    P&& predicate,
+    ThreadPool& pool = ThreadPool::get_default())
+{
+    Span<const T> input = seq.as_span();
+    size_t count = input.size();
+
+    DynamicArray<unsigned char> keep(static_cast<int>(count));
+    DynamicArray<size_t> chunk_counts(static_cast<int>(pool.get_thread_count()));
+
+    size_t chunks = pool.parallel_for(count, parallel_min_chunk,
+        [&](size_t chunk, size_t begin, size_t end) {
+            size_t kept = 0;
+            for (size_t i = begin; i < end; ++i)
+            {
+                bool matches = predicate(input[i]);
+                keep[static_cast<int>(i)] = matches;
+                kept += matches;
+            }
+            chunk_counts[static_cast<int>(chunk)] = kept;
+        });
+
+    size_t total = 0;
+    for (size_t chunk = 0; chunk < chunks; ++chunk)
+    {
+        size_t kept = chunk_counts[static_cast<int>(chunk)];
+        chunk_counts[static_cast<int>(chunk)] = total;
+        total += kept;
+    }
+
+    ArraySequence<T> result(static_cast<int>(total), seq.get_memory_resource());
+    Span<T> output(result.get_data(), total);
+
+    pool.parallel_for(count, parallel_min_chunk,
+        [&](size_t chunk, size_t begin, size_t end) {
+            size_t position = chunk_counts[static_cast<int>(chunk)];
+            for (size_t i = begin; i < end; ++i)
+            {
+                if (keep[static_cast<int>(i)])
+                    output[position++] = input[i];
+            }
+        });
+
+    return result;
+}
+
+// op must be associative; identity must be its neutral element. Chunks are
+// folded left to right, then the partial results in chunk order.
+template <typename T, typename Op>
+T parallel_reduce(
+    const ArraySequence<T>& seq,
+    T identity,
+    Op&& op,
+    ThreadPool& pool = ThreadPool::get_default())
+{
+    Span<const T> input = seq.as_span();
+    DynamicArray<T> partials(static_cast<int>(pool.get_thread_count()));
+
+    size_t chunks = pool.parallel_for(input.size(), parallel_min_chunk,
+        [&](size_t chunk, size_t begin, size_t end) {
+            T accumulator = identity;
+            for (size_t i = begin; i < end; ++i)
+                accumulator = op(std::move(accumulator), input[i]);
+            partials[static_cast<int>(chunk)] = std::move(accumulator);
+        });
+
+    T result = identity;
+    for (size_t chunk = 0; chunk < chunks; ++chunk)
+        result = op(std::move(result), partials[static_cast<int>(chunk)]);
+    return result;
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <optional>
 #include <stdexcept>
 
 #include "LazySequence.hpp"
@@ -12,6 +13,10 @@ private:
     size_t position;
     bool opened;
 
+    // set when the source knows its exact length, which spares probing
+    // the generator on every read
+    std::optional<size_t> length;
+
 public:
     explicit ReadOnlyStream(std::shared_ptr<LazySequence<T>> seq)
         : source(seq), position(0), opened(false)
@@ -22,6 +27,7 @@ public:
         if (!source)
             throw std::runtime_error("Stream has no source");
         opened = true;
+        length = source->size();
     }
 
     void close()
@@ -34,6 +40,9 @@ public:
         if (!opened)
             throw std::runtime_error("Stream is not opened");
 
+        if (length)
+            return position >= *length;
+
         return !(source->has_next() ||
                  position < source->get_materialized_count());
     }
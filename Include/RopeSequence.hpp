@@ -0,0 +1,581 @@
+#pragma once
+#include <algorithm>
+#include <memory>
+#include <memory_resource>
+#include <stdexcept>
+#include <utility>
+#include "Sequence.hpp"
+#include "DynamicArray.hpp"
+
+// Sequence for large, edit-heavy data: an implicit treap whose nodes each own
+// a chunk of up to chunk_capacity consecutive elements and know how many
+// elements their subtree holds. get, set, insert_at, remove and
+// get_subsequence walk O(log n) nodes; splices split and re-merge the tree
+// instead of shifting elements.
+//
+// Nodes and chunks are reference counted and copied on write, so copies and
+// subsequences share every node they have not modified. get() returns a
+// const reference into storage that may be shared that way, and set()
+// copies the chunk it writes to first. Not safe to use from several threads
+// at once.
+template <typename T>
+class RopeSequence : public Sequence<T>
+{
+public:
+    static constexpr int chunk_capacity =
+        sizeof(T) >= 128 ? 16 : 2048 / static_cast<int>(sizeof(T));
+
+private:
+    using Chunk = DynamicArray<T>;
+
+    struct Node;
+    using Link = std::shared_ptr<Node>;
+
+    struct Node {
+        std::shared_ptr<Chunk> chunk;
+        Link left;
+        Link right;
+        int size;
+        unsigned priority;
+    };
+
+    Link root;
+    std::pmr::memory_resource* resource;
+    unsigned seed;
+
+    RopeSequence(Link tree, std::pmr::memory_resource* resource);
+
+    template <typename U, typename... Args>
+    std::shared_ptr<U> make(Args&&... args) const;
+
+    unsigned next_priority();
+    Link make_node(const T* items, int count, unsigned priority) const;
+
+    static int size_of(const Link& node);
+    static void update(Node* node);
+
+    Link& detach(Link& node) const;
+    Chunk& own_chunk(Node* node) const;
+
+    void split(Link node, int index, Link& left, Link& right) const;
+    Link merge(Link left, Link right) const;
+
+    Node* locate(int index, bool inserting, int& offset) const;
+    bool insert_in_chunk(Link& link, int index, const T& item);
+    bool remove_in_chunk(Link& link, int index);
+    T& element_for_update(Link& link, int index);
+    void split_full_chunk(int index);
+
+    template <typename F>
+    static void for_each_chunk(const Link& node, F& func);
+
+public:
+    RopeSequence();
+    explicit RopeSequence(std::pmr::memory_resource* resource);
+    RopeSequence(const T* arr, int count, std::pmr::memory_resource* resource = nullptr);
+    RopeSequence(const RopeSequence<T>& other);
+    RopeSequence(RopeSequence<T>&& other) noexcept;
+    RopeSequence(const Sequence<T>& seq, std::pmr::memory_resource* resource = nullptr);
+    ~RopeSequence() override = default;
+
+    RopeSequence<T>* append(const T& item) override;
+    RopeSequence<T>* prepend(const T& item) override;
+    RopeSequence<T>* set(int index, const T& item) override;
+    RopeSequence<T>* remove(int index) override;
+    RopeSequence<T>* insert_at(int index, const Sequence<T>* other_seq) override;
+
+    RopeSequence<T>* insert(int index, const T& item);
+    RopeSequence<T>* append_range(const T* items, int count);
+
+    const T& get(int index) const override;
+    T get_first() const override;
+    T get_last() const override;
+    int get_size() const override;
+    std::pmr::memory_resource* get_memory_resource() const;
+
+    // Calls func(const T* items, int count) for every chunk in order; the
+    // cheap way to walk all elements.
+    template <typename F>
+    void for_each_chunk(F&& func) const;
+
+    RopeSequence<T>* get_subsequence(int start_index, int end_index) const override;
+    RopeSequence<T>* map(std::function<T(T)> func) override;
+    RopeSequence<T>* reset() override;
+    std::shared_ptr<const Sequence<T>> share() const override;
+
+    RopeSequence<T>& operator=(const RopeSequence<T>& other);
+    RopeSequence<T>& operator=(RopeSequence<T>&& other) noexcept;
+};
+
+    template <typename T>
+    RopeSequence<T>::RopeSequence(Link tree, std::pmr::memory_resource* resource)
+    : root(std::move(tree)), resource(resource), seed(2463534242u) {}
+
+    template <typename T>
+    template <typename U, typename... Args>
+    std::shared_ptr<U> RopeSequence<T>::make(Args&&... args) const {
+        if (resource == nullptr)
+            return std::make_shared<U>(std::forward<Args>(args)...);
+
+        return std::allocate_shared<U>(
+            std::pmr::polymorphic_allocator<U>(resource), std::forward<Args>(args)...);
+    }
+
+    template <typename T>
+    unsigned RopeSequence<T>::next_priority() {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        return seed;
+    }
+
+    template <typename T>
+    typename RopeSequence<T>::Link RopeSequence<T>::make_node(
+        const T* items, int count, unsigned priority) const {
+        Link node = make<Node>();
+        node->chunk = make<Chunk>(items, count, resource);
+        node->size = count;
+        node->priority = priority;
+        return node;
+    }
+
+    template <typename T>
+    int RopeSequence<T>::size_of(const Link& node) {
+        return node ? node->size : 0;
+    }
+
+    template <typename T>
+    void RopeSequence<T>::update(Node* node) {
+        node->size = size_of(node->left) + node->chunk->get_size() + size_of(node->right);
+    }
+
+    // Gives the caller a node it may modify: shared nodes are replaced by a
+    // shallow copy that still shares its chunk and children.
+    template <typename T>
+    typename RopeSequence<T>::Link& RopeSequence<T>::detach(Link& node) const {
+        if (node && node.use_count() > 1)
+            node = make<Node>(*node);
+        return node;
+    }
+
+    template <typename T>
+    typename RopeSequence<T>::Chunk& RopeSequence<T>::own_chunk(Node* node) const {
+        if (node->chunk.use_count() > 1)
+            node->chunk = make<Chunk>(*node->chunk, resource);
+        return *node->chunk;
+    }
+
+    // left receives the first index elements, right the rest. A chunk that
+    // straddles the cut is divided; both halves keep the node's priority.
+    template <typename T>
+    void RopeSequence<T>::split(Link node, int index, Link& left, Link& right) const {
+        if (!node) {
+            left = nullptr;
+            right = nullptr;
+            return;
+        }
+
+        Node* current = detach(node).get();
+        int left_size = size_of(current->left);
+        int chunk_size = current->chunk->get_size();
+
+        if (index <= left_size) {
+            Link subtree = std::move(current->left);
+            split(std::move(subtree), index, left, current->left);
+            update(current);
+            right = std::move(node);
+        } else if (index >= left_size + chunk_size) {
+            Link subtree = std::move(current->right);
+            split(std::move(subtree), index - left_size - chunk_size, current->right, right);
+            update(current);
+            left = std::move(node);
+        } else {
+            int offset = index - left_size;
+            const T* items = current->chunk->get_data();
+
+            Link tail = make_node(items + offset, chunk_size - offset, current->priority);
+            tail->right = std::move(current->right);
+            update(tail.get());
+
+            if (current->chunk.use_count() > 1)
+                current->chunk = make<Chunk>(items, offset, resource);
+            else
+                current->chunk->erase_range(offset, chunk_size - offset);
+            update(current);
+
+            left = std::move(node);
+            right = std::move(tail);
+        }
+    }
+
+    template <typename T>
+    typename RopeSequence<T>::Link RopeSequence<T>::merge(Link left, Link right) const {
+        if (!left)
+            return right;
+        if (!right)
+            return left;
+
+        if (left->priority >= right->priority) {
+            Node* current = detach(left).get();
+            current->right = merge(std::move(current->right), std::move(right));
+            update(current);
+            return left;
+        }
+
+        Node* current = detach(right).get();
+        current->left = merge(std::move(left), std::move(current->left));
+        update(current);
+        return right;
+    }
+
+    // Node whose chunk holds index. With inserting set, an index just past a
+    // chunk's last element also counts as inside that chunk.
+    template <typename T>
+    typename RopeSequence<T>::Node* RopeSequence<T>::locate(
+        int index, bool inserting, int& offset) const {
+        Node* current = root.get();
+        while (true) {
+            int left_size = size_of(current->left);
+            int chunk_size = current->chunk->get_size();
+
+            if (index < left_size) {
+                current = current->left.get();
+            } else if (index < left_size + chunk_size ||
+                       (inserting && index == left_size + chunk_size)) {
+                offset = index - left_size;
+                return current;
+            } else {
+                index -= left_size + chunk_size;
+                current = current->right.get();
+            }
+        }
+    }
+
+    // Both return false, leaving the elements untouched, when the chunk the
+    // index falls in cannot absorb the change.
+    template <typename T>
+    bool RopeSequence<T>::insert_in_chunk(Link& link, int index, const T& item) {
+        Node* current = detach(link).get();
+        int left_size = size_of(current->left);
+        int chunk_size = current->chunk->get_size();
+
+        bool inserted;
+        if (index < left_size) {
+            inserted = insert_in_chunk(current->left, index, item);
+        } else if (index <= left_size + chunk_size) {
+            if (chunk_size == chunk_capacity)
+                return false;
+            own_chunk(current).insert_range(index - left_size, &item, 1);
+            inserted = true;
+        } else {
+            inserted = insert_in_chunk(current->right, index - left_size - chunk_size, item);
+        }
+
+        if (inserted)
+            current->size++;
+        return inserted;
+    }
+
+    template <typename T>
+    bool RopeSequence<T>::remove_in_chunk(Link& link, int index) {
+        Node* current = detach(link).get();
+        int left_size = size_of(current->left);
+        int chunk_size = current->chunk->get_size();
+
+        bool removed;
+        if (index < left_size) {
+            removed = remove_in_chunk(current->left, index);
+        } else if (index < left_size + chunk_size) {
+            if (chunk_size == 1)
+                return false;
+            own_chunk(current).erase_range(index - left_size, 1);
+            removed = true;
+        } else {
+            removed = remove_in_chunk(current->right, index - left_size - chunk_size);
+        }
+
+        if (removed)
+            current->size--;
+        return removed;
+    }
+
+    template <typename T>
+    T& RopeSequence<T>::element_for_update(Link& link, int index) {
+        Node* current = detach(link).get();
+        int left_size = size_of(current->left);
+        int chunk_size = current->chunk->get_size();
+
+        if (index < left_size)
+            return element_for_update(current->left, index);
+        if (index < left_size + chunk_size)
+            return own_chunk(current)[index - left_size];
+        return element_for_update(current->right, index - left_size - chunk_size);
+    }
+
+    // Cuts the full chunk an insert at index lands in into two half-full
+    // nodes, like a B-tree leaf split.
+    template <typename T>
+    void RopeSequence<T>::split_full_chunk(int index) {
+        int offset;
+        locate(index, true, offset);
+        int chunk_start = index - offset;
+
+        Link before, rest, full, after;
+        split(std::move(root), chunk_start, before, rest);
+        split(std::move(rest), chunk_capacity, full, after);
+
+        Link upper;
+        split(std::move(full), chunk_capacity / 2, full, upper);
+        upper->priority = next_priority();
+
+        root = merge(merge(std::move(before), std::move(full)),
+                     merge(std::move(upper), std::move(after)));
+    }
+
+    template <typename T>
+    template <typename F>
+    void RopeSequence<T>::for_each_chunk(const Link& node, F& func) {
+        if (!node)
+            return;
+        for_each_chunk(node->left, func);
+        func(static_cast<const T*>(node->chunk->get_data()), node->chunk->get_size());
+        for_each_chunk(node->right, func);
+    }
+
+    template <typename T>
+    RopeSequence<T>::RopeSequence() : RopeSequence(Link(), nullptr) {}
+
+    template <typename T>
+    RopeSequence<T>::RopeSequence(std::pmr::memory_resource* resource)
+    : RopeSequence(Link(), resource) {}
+
+    template <typename T>
+    RopeSequence<T>::RopeSequence(const T* arr, int count, std::pmr::memory_resource* resource)
+    : RopeSequence(Link(), resource) {
+        append_range(arr, count);
+    }
+
+    template <typename T>
+    RopeSequence<T>::RopeSequence(const RopeSequence<T>& other)
+    : root(other.root), resource(other.resource), seed(other.seed) {}
+
+    template <typename T>
+    RopeSequence<T>::RopeSequence(RopeSequence<T>&& other) noexcept
+    : root(std::move(other.root)), resource(other.resource), seed(other.seed) {}
+
+    template <typename T>
+    RopeSequence<T>::RopeSequence(const Sequence<T>& seq, std::pmr::memory_resource* resource)
+    : RopeSequence(Link(), resource) {
+        insert_at(0, &seq);
+    }
+
+    template <typename T>
+    RopeSequence<T>* RopeSequence<T>::append(const T& item) {
+        return insert(get_size(), item);
+    }
+
+    template <typename T>
+    RopeSequence<T>* RopeSequence<T>::prepend(const T& item) {
+        return insert(0, item);
+    }
+
+    template <typename T>
+    RopeSequence<T>* RopeSequence<T>::insert(int index, const T& item) {
+        if (index < 0 || index > get_size())
+            throw std::out_of_range("Index out of range");
+
+        if (!root) {
+            root = make_node(&item, 1, next_priority());
+            return this;
+        }
+
+        if (insert_in_chunk(root, index, item))
+            return this;
+
+        split_full_chunk(index);
+        insert_in_chunk(root, index, item);
+        return this;
+    }
+
+    template <typename T>
+    RopeSequence<T>* RopeSequence<T>::set(int index, const T& item) {
+        if (index < 0 || index >= get_size())
+            throw std::out_of_range("Index out of range");
+
+        element_for_update(root, index) = item;
+        return this;
+    }
+
+    template <typename T>
+    RopeSequence<T>* RopeSequence<T>::remove(int index) {
+        if (index < 0 || index >= get_size())
+            throw std::out_of_range("Index out of range");
+
+        if (remove_in_chunk(root, index))
+            return this;
+
+        Link before, rest, removed;
+        split(std::move(root), index, before, rest);
+        split(std::move(rest), 1, removed, rest);
+        root = merge(std::move(before), std::move(rest));
+        return this;
+    }
+
+    // Another rope on the same memory resource is spliced in by sharing its
+    // nodes; anything else is copied into fresh chunks first.
+    template <typename T>
+    RopeSequence<T>* RopeSequence<T>::insert_at(int index, const Sequence<T>* other_seq) {
+        if (index < 0 || index > get_size())
+            throw std::out_of_range("Index out of range");
+
+        if (other_seq == nullptr)
+            throw std::invalid_argument("Other sequence cannot be null");
+
+        Link piece;
+        auto rope = dynamic_cast<const RopeSequence<T>*>(other_seq);
+        if (rope && rope->resource == resource) {
+            piece = rope->root;
+        } else {
+            RopeSequence<T> copy(resource);
+            copy.seed = next_priority();
+
+            Span<const T> contiguous = other_seq->as_span();
+            if (contiguous.data()) {
+                copy.append_range(contiguous.data(), static_cast<int>(contiguous.size()));
+            } else if (rope) {
+                rope->for_each_chunk([&copy](const T* items, int count) {
+                    copy.append_range(items, count);
+                });
+            } else {
+                DynamicArray<T> staged(resource);
+                staged.reserve(other_seq->get_size());
+                for (int i = 0; i < other_seq->get_size(); i++)
+                    staged.push_back(other_seq->get(i));
+                copy.append_range(staged.get_data(), staged.get_size());
+            }
+            piece = std::move(copy.root);
+        }
+
+        Link before, after;
+        split(std::move(root), index, before, after);
+        root = merge(merge(std::move(before), std::move(piece)), std::move(after));
+        return this;
+    }
+
+    template <typename T>
+    RopeSequence<T>* RopeSequence<T>::append_range(const T* items, int count) {
+        if (count < 0)
+            throw std::invalid_argument("Count cannot be negative");
+
+        Link tail;
+        for (int start = 0; start < count; start += chunk_capacity) {
+            int chunk_size = std::min(chunk_capacity, count - start);
+            tail = merge(std::move(tail), make_node(items + start, chunk_size, next_priority()));
+        }
+
+        root = merge(std::move(root), std::move(tail));
+        return this;
+    }
+
+    template <typename T>
+    const T& RopeSequence<T>::get(int index) const {
+        if (index < 0 || index >= get_size())
+            throw std::out_of_range("Index out of range");
+
+        int offset;
+        Node* node = locate(index, false, offset);
+        return (*node->chunk)[offset];
+    }
+
+    template <typename T>
+    T RopeSequence<T>::get_first() const {
+        if (get_size() == 0)
+            throw std::runtime_error("Sequence is empty");
+        return get(0);
+    }
+
+    template <typename T>
+    T RopeSequence<T>::get_last() const {
+        if (get_size() == 0)
+            throw std::runtime_error("Sequence is empty");
+        return get(get_size() - 1);
+    }
+
+    template <typename T>
+    int RopeSequence<T>::get_size() const {
+        return size_of(root);
+    }
+
+    template <typename T>
+    std::pmr::memory_resource* RopeSequence<T>::get_memory_resource() const {
+        return resource;
+    }
+
+    template <typename T>
+    template <typename F>
+    void RopeSequence<T>::for_each_chunk(F&& func) const {
+        for_each_chunk(root, func);
+    }
+
+    template <typename T>
+    RopeSequence<T>* RopeSequence<T>::get_subsequence(int start_index, int end_index) const {
+        if (get_size() == 0)
+            throw std::runtime_error("Sequence is empty");
+
+        if (start_index < 0 || end_index >= get_size() || start_index > end_index)
+            throw std::out_of_range("Invalid subsequence range");
+
+        Link head, middle, tail;
+        split(root, end_index + 1, head, tail);
+        split(std::move(head), start_index, tail, middle);
+
+        return new RopeSequence<T>(std::move(middle), resource);
+    }
+
+    template <typename T>
+    RopeSequence<T>* RopeSequence<T>::map(std::function<T(T)> func) {
+        auto mapped = new RopeSequence<T>(resource);
+        DynamicArray<T> scratch;
+
+        for_each_chunk([&](const T* items, int count) {
+            scratch.reset();
+            scratch.reserve(count);
+            for (int i = 0; i < count; i++)
+                scratch.push_back(func(items[i]));
+            mapped->append_range(scratch.get_data(), count);
+        });
+
+        return mapped;
+    }
+
+    template <typename T>
+    RopeSequence<T>* RopeSequence<T>::reset() {
+        root.reset();
+        return this;
+    }
+
+    // A snapshot: later edits to this rope copy the nodes they touch.
+    template <typename T>
+    std::shared_ptr<const Sequence<T>> RopeSequence<T>::share() const {
+        return make<RopeSequence<T>>(*this);
+    }
+
+    template <typename T>
+    RopeSequence<T>& RopeSequence<T>::operator=(const RopeSequence<T>& other) {
+        if (this != &other) {
+            root = other.root;
+            resource = other.resource;
+            seed = other.seed;
+        }
+        return *this;
+    }
+
+    template <typename T>
+    RopeSequence<T>& RopeSequence<T>::operator=(RopeSequence<T>&& other) noexcept {
+        if (this != &other) {
+            root = std::move(other.root);
+            resource = other.resource;
+            seed = other.seed;
+        }
+        return *this;
+    }
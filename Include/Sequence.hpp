@@ -1,6 +1,8 @@
 #pragma once
 #include <string>
 #include <functional>
+#include <memory>
+#include "Span.hpp"
 
 template <typename T>
 class Sequence
@@ -14,11 +16,20 @@ public:
     virtual Sequence<T>* set(int index, const T& item) = 0;
     virtual Sequence<T>* remove(int index) = 0;
     virtual Sequence<T>* insert_at(int index, const Sequence<T>* other_seq) = 0;
-    virtual T& get(int index) const = 0;
+    virtual const T& get(int index) const = 0;
     virtual T get_first() const = 0;
     virtual T get_last() const = 0;
     virtual int get_size() const = 0;
     virtual Sequence<T>* get_subsequence(int start_index, int end_index) const = 0;
     virtual Sequence<T>* map(std::function<T(T)> func) = 0;
     virtual Sequence<T>* reset() = 0;
+
+    // Direct read-only view of the elements when they are stored
+    // contiguously, so hot loops can skip the virtual get(); a null data()
+    // otherwise.
+    virtual Span<const T> as_span() const { return Span<const T>(); }
+
+    // Handle that keeps the current elements alive independently of this
+    // object, when one can be made without copying them; null otherwise.
+    virtual std::shared_ptr<const Sequence<T>> share() const { return nullptr; }
 };
\ No newline at end of file
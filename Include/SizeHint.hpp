@@ -0,0 +1,73 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+
+// How many elements are left to produce: exactly value, at most value, or
+// unknown. Hints combine the way the stages combine their inputs, and an
+// exact hint only ever comes from sources that can count.
+struct SizeHint
+{
+    enum class Kind { exact, bounded, unknown };
+
+    Kind kind;
+    size_t value;
+
+    static SizeHint exact(size_t count)
+    {
+        return { Kind::exact, count };
+    }
+
+    static SizeHint at_most(size_t count)
+    {
+        return { Kind::bounded, count };
+    }
+
+    static SizeHint unknown()
+    {
+        return { Kind::unknown, 0 };
+    }
+
+    bool is_exact() const
+    {
+        return kind == Kind::exact;
+    }
+
+    bool is_known() const
+    {
+        return kind != Kind::unknown;
+    }
+
+    // Both parts one after the other.
+    SizeHint operator+(SizeHint other) const
+    {
+        if (!is_known() || !other.is_known())
+            return unknown();
+
+        size_t sum = value > std::numeric_limits<size_t>::max() - other.value
+            ? std::numeric_limits<size_t>::max()
+            : value + other.value;
+        return { is_exact() && other.is_exact() ? Kind::exact : Kind::bounded, sum };
+    }
+
+    // What is left once count elements have been taken.
+    SizeHint after(size_t count) const
+    {
+        return { kind, value - std::min(value, count) };
+    }
+
+    // No more than count of it.
+    SizeHint capped(size_t count) const
+    {
+        if (!is_known())
+            return at_most(count);
+        return { kind, std::min(value, count) };
+    }
+
+    // Any number up to this one, e.g. what a filter lets through.
+    SizeHint loosened() const
+    {
+        return is_known() ? at_most(value) : unknown();
+    }
+};
@@ -0,0 +1,317 @@
+#pragma once
+#include <cassert>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include "Sequence.hpp"
+#include "ArraySequence.hpp"
+
+// Fixed window over contiguous elements owned by someone else. Slicing and
+// get_subsequence are O(1) and never copy; set() writes through to the
+// underlying storage. The window cannot grow or shrink, so append, prepend,
+// remove and insert_at throw. The viewed storage must outlive the slice and
+// must not be reallocated while it is in use. A slice cut from an
+// ArraySequence pins it (see ArraySequence::pin) until the slice and every
+// slice taken from it are gone, so copies made meanwhile get storage of
+// their own and set() never reaches them.
+template <typename T>
+class SliceSequence : public Sequence<T>
+{
+protected:
+    T* items;
+    int count;
+
+    // keeps the viewed storage alive for SharedSliceSequence; declared
+    // before pinned, so a pinned sequence it owns is unpinned first
+    std::shared_ptr<const void> owner;
+    ArraySequence<T>* pinned;
+
+    static Span<T> window(Span<T> span, int start_index, int end_index);
+    void view_pinned(ArraySequence<T>* source);
+    void release();
+
+public:
+    SliceSequence();
+    SliceSequence(T* items, int count);
+    explicit SliceSequence(Span<T> span);
+    SliceSequence(Sequence<T>& seq, int start_index, int end_index);
+    SliceSequence(const SliceSequence<T>& other);
+    ~SliceSequence() override;
+
+    SliceSequence<T>& operator=(const SliceSequence<T>& other);
+
+    SliceSequence<T>* append(const T& item) override;
+    SliceSequence<T>* prepend(const T& item) override;
+    SliceSequence<T>* set(int index, const T& item) override;
+    SliceSequence<T>* remove(int index) override;
+    SliceSequence<T>* insert_at(int index, const Sequence<T>* other_seq) override;
+
+    const T& get(int index) const override;
+    T& operator[](int index) const;
+    T get_first() const override;
+    T get_last() const override;
+    int get_size() const override;
+
+    T* begin() const;
+    T* end() const;
+    Span<const T> as_span() const override;
+
+    SliceSequence<T>* get_subsequence(int start_index, int end_index) const override;
+    ArraySequence<T>* map(std::function<T(T)> func) override;
+    SliceSequence<T>* reset() override;
+};
+
+// Slice that holds a reference on the buffer it views, so it may outlive
+// the sequence it was cut from. All slices of one buffer see each other's
+// set() calls.
+template <typename T>
+class SharedSliceSequence : public SliceSequence<T>
+{
+public:
+    SharedSliceSequence() = default;
+    SharedSliceSequence(std::shared_ptr<const void> owner, Span<T> span);
+    explicit SharedSliceSequence(ArraySequence<T>&& source);
+    explicit SharedSliceSequence(std::shared_ptr<ArraySequence<T>> source);
+    SharedSliceSequence(std::shared_ptr<ArraySequence<T>> source, int start_index, int end_index);
+
+    SharedSliceSequence<T>* get_subsequence(int start_index, int end_index) const override;
+    SharedSliceSequence<T>* reset() override;
+    std::shared_ptr<const Sequence<T>> share() const override;
+};
+
+    template <typename T>
+    Span<T> SliceSequence<T>::window(Span<T> span, int start_index, int end_index) {
+        if (start_index < 0 || end_index >= static_cast<int>(span.size()) || start_index > end_index)
+            throw std::out_of_range("Invalid slice range");
+
+        return span.subspan(start_index, end_index - start_index + 1);
+    }
+
+    template <typename T>
+    void SliceSequence<T>::view_pinned(ArraySequence<T>* source) {
+        items = source->pin();
+        count = source->get_size();
+        pinned = source;
+    }
+
+    template <typename T>
+    void SliceSequence<T>::release() {
+        if (pinned)
+            pinned->unpin();
+        pinned = nullptr;
+        owner.reset();
+    }
+
+    template <typename T>
+    SliceSequence<T>::SliceSequence() : items(nullptr), count(0), pinned(nullptr) {}
+
+    template <typename T>
+    SliceSequence<T>::SliceSequence(T* items, int count)
+    : items(items), count(count), pinned(nullptr) {
+        if (count < 0)
+            throw std::invalid_argument("Slice size cannot be negative");
+    }
+
+    template <typename T>
+    SliceSequence<T>::SliceSequence(Span<T> span)
+    : items(span.data()), count(static_cast<int>(span.size())), pinned(nullptr) {}
+
+    // A bad range throws once the slice is complete, so the destructor
+    // gives the pin back.
+    template <typename T>
+    SliceSequence<T>::SliceSequence(Sequence<T>& seq, int start_index, int end_index)
+    : SliceSequence() {
+        if (auto array = dynamic_cast<ArraySequence<T>*>(&seq)) {
+            view_pinned(array);
+        } else if (auto slice = dynamic_cast<SliceSequence<T>*>(&seq)) {
+            *this = *slice;
+        } else {
+            throw std::invalid_argument("Sequence is not stored contiguously");
+        }
+
+        Span<T> part = window(Span<T>(items, count), start_index, end_index);
+        items = part.data();
+        count = static_cast<int>(part.size());
+    }
+
+    template <typename T>
+    SliceSequence<T>::SliceSequence(const SliceSequence<T>& other)
+    : items(other.items), count(other.count), owner(other.owner), pinned(other.pinned) {
+        if (pinned)
+            pinned->pin();
+    }
+
+    template <typename T>
+    SliceSequence<T>::~SliceSequence() {
+        release();
+    }
+
+    template <typename T>
+    SliceSequence<T>& SliceSequence<T>::operator=(const SliceSequence<T>& other) {
+        if (this != &other) {
+            if (other.pinned)
+                other.pinned->pin();
+            release();
+            items = other.items;
+            count = other.count;
+            owner = other.owner;
+            pinned = other.pinned;
+        }
+        return *this;
+    }
+
+    template <typename T>
+    SliceSequence<T>* SliceSequence<T>::append(const T&) {
+        throw std::runtime_error("SliceSequence cannot change size");
+    }
+
+    template <typename T>
+    SliceSequence<T>* SliceSequence<T>::prepend(const T&) {
+        throw std::runtime_error("SliceSequence cannot change size");
+    }
+
+    template <typename T>
+    SliceSequence<T>* SliceSequence<T>::set(int index, const T& item) {
+        if (index < 0 || index >= count)
+            throw std::out_of_range("Index out of range");
+        items[index] = item;
+        return this;
+    }
+
+    template <typename T>
+    SliceSequence<T>* SliceSequence<T>::remove(int) {
+        throw std::runtime_error("SliceSequence cannot change size");
+    }
+
+    template <typename T>
+    SliceSequence<T>* SliceSequence<T>::insert_at(int, const Sequence<T>*) {
+        throw std::runtime_error("SliceSequence cannot change size");
+    }
+
+    template <typename T>
+    const T& SliceSequence<T>::get(int index) const {
+        if (index < 0 || index >= count)
+            throw std::out_of_range("Index out of range");
+        return items[index];
+    }
+
+    template <typename T>
+    T& SliceSequence<T>::operator[](int index) const {
+        assert(index >= 0 && index < count);
+        return items[index];
+    }
+
+    template <typename T>
+    T SliceSequence<T>::get_first() const {
+        if (count == 0)
+            throw std::runtime_error("Sequence is empty");
+        return items[0];
+    }
+
+    template <typename T>
+    T SliceSequence<T>::get_last() const {
+        if (count == 0)
+            throw std::runtime_error("Sequence is empty");
+        return items[count - 1];
+    }
+
+    template <typename T>
+    int SliceSequence<T>::get_size() const {
+        return count;
+    }
+
+    template <typename T>
+    T* SliceSequence<T>::begin() const {
+        return items;
+    }
+
+    template <typename T>
+    T* SliceSequence<T>::end() const {
+        return items + count;
+    }
+
+    template <typename T>
+    Span<const T> SliceSequence<T>::as_span() const {
+        return Span<const T>(items, count);
+    }
+
+    template <typename T>
+    SliceSequence<T>* SliceSequence<T>::get_subsequence(int start_index, int end_index) const {
+        if (count == 0)
+            throw std::runtime_error("Sequence is empty");
+
+        Span<T> part = window(Span<T>(items, count), start_index, end_index);
+        SliceSequence<T>* slice = new SliceSequence<T>(*this);
+        slice->items = part.data();
+        slice->count = static_cast<int>(part.size());
+        return slice;
+    }
+
+    // A view cannot own new elements, so the result is a fresh ArraySequence.
+    template <typename T>
+    ArraySequence<T>* SliceSequence<T>::map(std::function<T(T)> func) {
+        ArraySequence<T>* mapped = new ArraySequence<T>(count);
+        for (int i = 0; i < count; i++) {
+            (*mapped)[i] = func(items[i]);
+        }
+        return mapped;
+    }
+
+    template <typename T>
+    SliceSequence<T>* SliceSequence<T>::reset() {
+        release();
+        items = nullptr;
+        count = 0;
+        return this;
+    }
+
+    template <typename T>
+    SharedSliceSequence<T>::SharedSliceSequence(std::shared_ptr<const void> owner, Span<T> span)
+    : SliceSequence<T>(span) {
+        this->owner = std::move(owner);
+    }
+
+    template <typename T>
+    SharedSliceSequence<T>::SharedSliceSequence(ArraySequence<T>&& source)
+    : SharedSliceSequence(std::make_shared<ArraySequence<T>>(std::move(source))) {}
+
+    template <typename T>
+    SharedSliceSequence<T>::SharedSliceSequence(std::shared_ptr<ArraySequence<T>> source) {
+        if (!source)
+            throw std::invalid_argument("Source sequence cannot be null");
+
+        this->view_pinned(source.get());
+        this->owner = std::move(source);
+    }
+
+    template <typename T>
+    SharedSliceSequence<T>::SharedSliceSequence(
+        std::shared_ptr<ArraySequence<T>> source, int start_index, int end_index)
+    : SharedSliceSequence(std::move(source)) {
+        Span<T> part = this->window(Span<T>(this->items, this->count), start_index, end_index);
+        this->items = part.data();
+        this->count = static_cast<int>(part.size());
+    }
+
+    template <typename T>
+    SharedSliceSequence<T>* SharedSliceSequence<T>::get_subsequence(int start_index, int end_index) const {
+        if (this->count == 0)
+            throw std::runtime_error("Sequence is empty");
+
+        Span<T> part = this->window(Span<T>(this->items, this->count), start_index, end_index);
+        SharedSliceSequence<T>* slice = new SharedSliceSequence<T>(*this);
+        slice->items = part.data();
+        slice->count = static_cast<int>(part.size());
+        return slice;
+    }
+
+    template <typename T>
+    SharedSliceSequence<T>* SharedSliceSequence<T>::reset() {
+        SliceSequence<T>::reset();
+        return this;
+    }
+
+    template <typename T>
+    std::shared_ptr<const Sequence<T>> SharedSliceSequence<T>::share() const {
+        return std::make_shared<SharedSliceSequence<T>>(*this);
+    }
@@ -0,0 +1,97 @@
+#pragma once
+#include <type_traits>
+#include "ArraySequence.hpp"
+
+// ArraySequence that keeps its first N elements in an inline buffer and only
+// touches the heap once it outgrows it. Meant for short-lived scratch
+// sequences, e.g. the argument window of a recurrence rule. Moving one only
+// moves elements between inline buffers of the same size or hands a heap
+// block over, so it cannot throw unless moving a T can.
+template <typename T, int N>
+class SmallArraySequence : public ArraySequence<T>
+{
+    static_assert(N > 0, "SmallArraySequence needs a positive inline capacity");
+
+private:
+    alignas(T) unsigned char storage[N * sizeof(T)];
+
+    // Static: the base is built from it before this object exists, so only
+    // the address of storage may be used, not a member call.
+    static InlineBuffer<T> inline_buffer(unsigned char* storage);
+
+public:
+    SmallArraySequence();
+    SmallArraySequence(int initial_size);
+    SmallArraySequence(const T* arr, int count);
+    SmallArraySequence(const SmallArraySequence<T, N>& other);
+    SmallArraySequence(SmallArraySequence<T, N>&& other)
+        noexcept(std::is_nothrow_move_constructible_v<T>);
+    SmallArraySequence(const Sequence<T>& seq);
+    ~SmallArraySequence() override = default;
+
+    SmallArraySequence<T, N>& operator=(const SmallArraySequence<T, N>& other);
+    SmallArraySequence<T, N>& operator=(SmallArraySequence<T, N>&& other)
+        noexcept(std::is_nothrow_move_constructible_v<T>);
+};
+
+    template <typename T, int N>
+    InlineBuffer<T> SmallArraySequence<T, N>::inline_buffer(unsigned char* storage) {
+        return InlineBuffer<T>{ reinterpret_cast<T*>(storage), N };
+    }
+
+    template <typename T, int N>
+    SmallArraySequence<T, N>::SmallArraySequence() : ArraySequence<T>(inline_buffer(storage)) {}
+
+    template <typename T, int N>
+    SmallArraySequence<T, N>::SmallArraySequence(int initial_size)
+    : ArraySequence<T>(inline_buffer(storage)) {
+        this->array.resize(initial_size);
+    }
+
+    template <typename T, int N>
+    SmallArraySequence<T, N>::SmallArraySequence(const T* arr, int count)
+    : ArraySequence<T>(inline_buffer(storage)) {
+        this->array.reserve(count);
+        for (int i = 0; i < count; i++) {
+            this->array.push_back(arr[i]);
+        }
+    }
+
+    template <typename T, int N>
+    SmallArraySequence<T, N>::SmallArraySequence(const SmallArraySequence<T, N>& other)
+    : ArraySequence<T>(inline_buffer(storage)) {
+        this->array = other.array;
+    }
+
+    template <typename T, int N>
+    SmallArraySequence<T, N>::SmallArraySequence(SmallArraySequence<T, N>&& other)
+        noexcept(std::is_nothrow_move_constructible_v<T>)
+    : ArraySequence<T>(inline_buffer(storage)) {
+        this->array = std::move(other.array);
+    }
+
+    template <typename T, int N>
+    SmallArraySequence<T, N>::SmallArraySequence(const Sequence<T>& seq)
+    : ArraySequence<T>(inline_buffer(storage)) {
+        this->array.reserve(seq.get_size());
+        for (int i = 0; i < seq.get_size(); i++) {
+            this->array.push_back(seq.get(i));
+        }
+    }
+
+    template <typename T, int N>
+    SmallArraySequence<T, N>& SmallArraySequence<T, N>::operator=(const SmallArraySequence<T, N>& other) {
+        if (this != &other) {
+            this->array = other.array;
+        }
+        return *this;
+    }
+
+    template <typename T, int N>
+    SmallArraySequence<T, N>& SmallArraySequence<T, N>::operator=(SmallArraySequence<T, N>&& other)
+        noexcept(std::is_nothrow_move_constructible_v<T>) {
+        if (this != &other) {
+            this->array = std::move(other.array);
+        }
+        return *this;
+    }
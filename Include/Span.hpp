@@ -0,0 +1,43 @@
+#pragma once
+#include <cassert>
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+
+// Non-owning view over contiguous elements, in the spirit of C++20 std::span.
+// A view with a null data() means the viewed storage is not contiguous.
+template <typename T>
+class Span
+{
+private:
+    T* items;
+    size_t count;
+
+public:
+    Span() : items(nullptr), count(0) {}
+    Span(T* items, size_t count) : items(items), count(count) {}
+
+    // Span<T> converts to Span<const T>, not the other way round.
+    template <typename U, typename = std::enable_if_t<std::is_convertible_v<U (*)[], T (*)[]>>>
+    Span(const Span<U>& other) : items(other.data()), count(other.size()) {}
+
+    T* data() const { return items; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    T* begin() const { return items; }
+    T* end() const { return items + count; }
+
+    T& operator[](size_t index) const
+    {
+        assert(index < count);
+        return items[index];
+    }
+
+    Span<T> subspan(size_t offset, size_t length) const
+    {
+        if (offset > count || length > count - offset)
+            throw std::out_of_range("Span::subspan range out of range");
+        return Span<T>(items + offset, length);
+    }
+};
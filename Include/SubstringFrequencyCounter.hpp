@@ -27,7 +27,7 @@ public:
             throw std::invalid_argument("Pattern must not be empty");
 
         for (int i = 0; i < pat.size(); ++i)
-            pattern.set(i, pat[i]);
+            pattern[i] = pat[i];
     }
 
     size_t count(ReadOnlyStream<char>& stream)
@@ -44,7 +44,7 @@ public:
             if (is_delimiter(c))
                 continue;
 
-            if (c == pattern.get(matched))
+            if (c == pattern[matched])
             {
                 ++matched;
                 if (matched == pattern.get_size())
@@ -55,7 +55,7 @@ public:
             }
             else
             {
-                if (c == pattern.get(0))
+                if (c == pattern[0])
                     matched = 1;
                 else
                     matched = 0;
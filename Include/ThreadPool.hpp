@@ -0,0 +1,193 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads fed from one task queue. The thread that calls
+// parallel_for takes part in the work, so a pool of n threads runs n - 1
+// workers and a pool of 1 runs everything inline. While it waits for the
+// other chunks it runs queued tasks too, so parallel_for may be called from
+// inside a pool task without every worker blocking on work nobody picks up.
+class ThreadPool
+{
+private:
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable task_available;
+    bool stopping;
+
+    void worker_loop()
+    {
+        while (true)
+        {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                task_available.wait(lock, [this] { return stopping || !tasks.empty(); });
+
+                if (tasks.empty())
+                    return;
+
+                task = std::move(tasks.front());
+                tasks.pop();
+            }
+            task();
+        }
+    }
+
+    // Runs one queued task on the calling thread, if there is one.
+    bool run_pending_task()
+    {
+        std::function<void()> task;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (tasks.empty())
+                return false;
+
+            task = std::move(tasks.front());
+            tasks.pop();
+        }
+        task();
+        return true;
+    }
+
+public:
+    explicit ThreadPool(size_t thread_count = std::thread::hardware_concurrency())
+        : stopping(false)
+    {
+        if (thread_count == 0)
+            thread_count = 1;
+
+        for (size_t i = 1; i < thread_count; ++i)
+            workers.emplace_back([this] { worker_loop(); });
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        task_available.notify_all();
+
+        for (auto& worker : workers)
+            worker.join();
+    }
+
+    static ThreadPool& get_default()
+    {
+        static ThreadPool pool;
+        return pool;
+    }
+
+    size_t get_thread_count() const
+    {
+        return workers.size() + 1;
+    }
+
+    void submit(std::function<void()> task)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            tasks.push(std::move(task));
+        }
+        task_available.notify_one();
+    }
+
+    // Splits [0, count) into at most get_thread_count() contiguous chunks of
+    // at least min_chunk elements and calls body(chunk, begin, end) for each.
+    // Returns once every chunk is done; the first exception is rethrown.
+    template <typename F>
+    size_t parallel_for(size_t count, size_t min_chunk, F&& body)
+    {
+        if (count == 0)
+            return 0;
+
+        size_t chunks = std::min(get_thread_count(), (count + min_chunk - 1) / std::max<size_t>(min_chunk, 1));
+        chunks = std::max<size_t>(chunks, 1);
+
+        size_t chunk_size = (count + chunks - 1) / chunks;
+        chunks = (count + chunk_size - 1) / chunk_size;
+
+        if (chunks == 1)
+        {
+            body(size_t(0), size_t(0), count);
+            return 1;
+        }
+
+        std::mutex done_mutex;
+        std::condition_variable done;
+        size_t remaining = chunks - 1;
+        std::exception_ptr failure;
+
+        for (size_t chunk = 1; chunk < chunks; ++chunk)
+        {
+            size_t begin = chunk * chunk_size;
+            size_t end = std::min(count, begin + chunk_size);
+
+            submit([&, chunk, begin, end] {
+                std::exception_ptr error;
+                try
+                {
+                    body(chunk, begin, end);
+                }
+                catch (...)
+                {
+                    error = std::current_exception();
+                }
+
+                std::lock_guard<std::mutex> lock(done_mutex);
+                if (error && !failure)
+                    failure = error;
+                if (--remaining == 0)
+                    done.notify_one();
+            });
+        }
+
+        std::exception_ptr local_failure;
+        try
+        {
+            body(size_t(0), size_t(0), std::min(count, chunk_size));
+        }
+        catch (...)
+        {
+            local_failure = std::current_exception();
+        }
+
+        while (true)
+        {
+            {
+                std::lock_guard<std::mutex> lock(done_mutex);
+                if (remaining == 0)
+                    break;
+            }
+
+            // Once the queue is empty every unfinished chunk is running on
+            // some thread, so blocking here cannot starve it.
+            if (!run_pending_task())
+            {
+                std::unique_lock<std::mutex> lock(done_mutex);
+                done.wait(lock, [&] { return remaining == 0; });
+                break;
+            }
+        }
+
+        if (local_failure)
+            std::rethrow_exception(local_failure);
+        if (failure)
+            std::rethrow_exception(failure);
+
+        return chunks;
+    }
+};
@@ -0,0 +1,76 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+#include "LazySequence.hpp"
+#include "ArraySequence.hpp"
+
+// A long map/where chain materialized in one request (get of its last
+// element) and one element at a time (get_next until exhausted).
+// Usage: batch_benchmark [count] [stages] [repetitions]
+
+static std::shared_ptr<LazySequence<long long>> build_chain(
+    const ArraySequence<long long>& source, int stages)
+{
+    auto chain = LazySequence<long long>::create(source);
+    for (int s = 0; s < stages; ++s)
+    {
+        chain = chain
+            ->map<long long>([](const long long& x) { return x * 3 + 1; })
+            ->where([](long long x) { return x % 5 != 0; });
+    }
+    return chain;
+}
+
+template <typename F>
+static void measure(const char* name, int repetitions, F&& body)
+{
+    long long checksum = 0;
+
+    auto begin = std::chrono::steady_clock::now();
+    for (int r = 0; r < repetitions; ++r)
+        checksum += body();
+    auto end = std::chrono::steady_clock::now();
+
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count();
+    std::cout << name << ": " << us / repetitions << " us (checksum " << checksum << ")\n";
+}
+
+int main(int argc, char** argv)
+{
+    int count = argc > 1 ? std::atoi(argv[1]) : 1000000;
+    int stages = argc > 2 ? std::atoi(argv[2]) : 4;
+    int repetitions = argc > 3 ? std::atoi(argv[3]) : 5;
+
+    ArraySequence<long long> source;
+    for (int i = 0; i < count; ++i)
+        source.append(i);
+
+    size_t survivors = 0;
+    {
+        auto chain = build_chain(source, stages);
+        while (chain->has_next())
+        {
+            chain->get_next();
+            ++survivors;
+        }
+    }
+
+    if (survivors == 0)
+        return 0;
+
+    measure("whole chain, one get   ", repetitions, [&] {
+        auto chain = build_chain(source, stages);
+        return chain->get(survivors - 1);
+    });
+
+    measure("whole chain, get_next  ", repetitions, [&] {
+        auto chain = build_chain(source, stages);
+        long long last = 0;
+        while (chain->has_next())
+            last = chain->get_next();
+        return last;
+    });
+
+    return 0;
+}
@@ -0,0 +1,82 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+#include "ArraySequence.hpp"
+
+// map and get_subsequence written against the range-checked get()/set() and
+// against the unchecked operator[] the library loops use.
+// Usage: bounds_check_benchmark [count] [repetitions]
+
+template <typename F>
+static void measure(const char* name, int repetitions, F&& body)
+{
+    long long checksum = 0;
+
+    auto begin = std::chrono::steady_clock::now();
+    for (int r = 0; r < repetitions; ++r)
+        checksum += body();
+    auto end = std::chrono::steady_clock::now();
+
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count();
+    std::cout << name << ": " << us / repetitions << " us (checksum " << checksum << ")\n";
+}
+
+int main(int argc, char** argv)
+{
+    int count = argc > 1 ? std::atoi(argv[1]) : 10000000;
+    int repetitions = argc > 2 ? std::atoi(argv[2]) : 10;
+
+    ArraySequence<int> source(count);
+    for (int i = 0; i < count; ++i)
+        source[i] = i % 1000;
+
+    auto twice = [](int x) { return x * 2; };
+
+    measure("map, checked get/set         ", repetitions, [&] {
+        ArraySequence<int> mapped(count);
+        for (int i = 0; i < source.get_size(); ++i)
+            mapped.set(i, twice(source.get(i)));
+        return static_cast<long long>(mapped.get(count / 2 + 7));
+    });
+
+    measure("map, unchecked operator[]    ", repetitions, [&] {
+        ArraySequence<int> mapped(count);
+        for (int i = 0; i < source.get_size(); ++i)
+            mapped[i] = twice(source[i]);
+        return static_cast<long long>(mapped[count / 2 + 7]);
+    });
+
+    measure("map, library                 ", repetitions, [&] {
+        ArraySequence<int>* mapped = source.map(twice);
+        long long item = (*mapped)[count / 2 + 7];
+        delete mapped;
+        return item;
+    });
+
+    int from = count / 4;
+    int to = count - count / 4;
+
+    measure("subsequence, checked get     ", repetitions, [&] {
+        ArraySequence<int> sub;
+        for (int i = from; i <= to; ++i)
+            sub.append(source.get(i));
+        return static_cast<long long>(sub.get_size());
+    });
+
+    measure("subsequence, unchecked []    ", repetitions, [&] {
+        ArraySequence<int> sub;
+        for (int i = from; i <= to; ++i)
+            sub.append(source[i]);
+        return static_cast<long long>(sub.get_size());
+    });
+
+    measure("subsequence, library         ", repetitions, [&] {
+        ArraySequence<int>* sub = source.get_subsequence(from, to);
+        long long size = sub->get_size();
+        delete sub;
+        return size;
+    });
+
+    return 0;
+}
@@ -0,0 +1,101 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory_resource>
+#include <new>
+
+#include "Generator.hpp"
+#include "LazySequence.hpp"
+#include "ReadOnlyStream.hpp"
+#include "SubstringFrequencyCounter.hpp"
+
+// Substring count over many stream segments appended one after another,
+// read once from start to end. Peak bytes count every buffer the segments
+// and the chain take from their memory resource.
+// Usage: concat_benchmark [segments] [kilobytes per segment]
+
+class Peak_Resource : public std::pmr::memory_resource
+{
+public:
+    size_t live = 0;
+    size_t peak = 0;
+
+protected:
+    void* do_allocate(size_t bytes, size_t) override
+    {
+        live += bytes;
+        peak = live > peak ? live : peak;
+        if (void* ptr = std::malloc(bytes))
+            return ptr;
+        throw std::bad_alloc();
+    }
+
+    void do_deallocate(void* ptr, size_t bytes, size_t) override
+    {
+        live -= bytes;
+        std::free(ptr);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+    {
+        return this == &other;
+    }
+};
+
+// "lorem ipsum dolor " repeated up to a given length, without holding it.
+class Text_Generator : public Generator<char>
+{
+private:
+    static constexpr const char* text = "lorem ipsum dolor ";
+    static constexpr size_t text_length = 18;
+
+    size_t position;
+    size_t length;
+
+public:
+    explicit Text_Generator(size_t length) : position(0), length(length) {}
+
+    char get_next() override
+    {
+        if (!has_next())
+            throw std::runtime_error("End of text");
+        return text[position++ % text_length];
+    }
+
+    bool has_next() override
+    {
+        return position < length;
+    }
+};
+
+int main(int argc, char** argv)
+{
+    int segments = argc > 1 ? std::atoi(argv[1]) : 64;
+    size_t kilobytes = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 1024;
+
+    Peak_Resource heap;
+    size_t found;
+
+    auto begin = std::chrono::steady_clock::now();
+    {
+        std::shared_ptr<LazySequence<char>> all;
+        for (int i = 0; i < segments; ++i)
+        {
+            auto segment = std::make_shared<LazySequence<char>>(
+                std::make_unique<Text_Generator>(kilobytes << 10), &heap);
+            all = all ? all->append(segment) : segment;
+        }
+        all->set_retention(RetentionPolicy::release_below_cursor());
+
+        ReadOnlyStream<char> stream(all);
+        SubstringFrequencyCounter counter("ipsum");
+        found = counter.count(stream);
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count();
+    std::cout << segments << " segments: " << ms << " ms, peak " << heap.peak << " bytes"
+              << " (found " << found << ")\n";
+
+    return 0;
+}
@@ -0,0 +1,79 @@
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "ConcurrentLazySequence.hpp"
+#include "LazySequence.hpp"
+
+// Threads reading every element of one shared recurrence, at 1, 2, 4 and 8
+// threads: a LazySequence behind a mutex, and a ConcurrentLazySequence both
+// while it is still being generated (cold) and once it is materialized
+// (warm, lock-free).
+// Usage: concurrent_benchmark [count] [passes]
+
+static unsigned long long lcg(const ArraySequence<unsigned long long>& s)
+{
+    return s[0] * 6364136223846793005ULL + 1442695040888963407ULL;
+}
+
+template <typename F>
+static long long measure_ms(size_t threads, F&& read_all)
+{
+    std::vector<std::thread> readers;
+
+    auto begin = std::chrono::steady_clock::now();
+    for (size_t t = 0; t < threads; ++t)
+        readers.emplace_back(read_all);
+    for (auto& reader : readers)
+        reader.join();
+    auto end = std::chrono::steady_clock::now();
+
+    return std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count();
+}
+
+int main(int argc, char** argv)
+{
+    size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2000000;
+    int passes = argc > 2 ? std::atoi(argv[2]) : 5;
+
+    ArraySequence<unsigned long long> start;
+    start.append(1);
+
+    for (size_t threads : { 1, 2, 4, 8 })
+    {
+        std::atomic<unsigned long long> checksum(0);
+
+        auto locked = LazySequence<unsigned long long>::create(start, 1, lcg);
+        std::mutex lock;
+        long long locked_ms = measure_ms(threads, [&] {
+            unsigned long long sum = 0;
+            for (int p = 0; p < passes; ++p)
+                for (size_t i = 0; i < count; ++i)
+                {
+                    std::lock_guard<std::mutex> guard(lock);
+                    sum += locked->get(i);
+                }
+            checksum += sum;
+        });
+
+        auto shared = ConcurrentLazySequence<unsigned long long>::create(start, 1, lcg);
+        auto read_all = [&] {
+            unsigned long long sum = 0;
+            for (int p = 0; p < passes; ++p)
+                for (size_t i = 0; i < count; ++i)
+                    sum += shared->get(i);
+            checksum += sum;
+        };
+        long long cold_ms = measure_ms(threads, read_all);
+        long long warm_ms = measure_ms(threads, read_all);
+
+        std::cout << threads << " threads: mutex " << locked_ms << " ms, concurrent cold "
+                  << cold_ms << " ms, warm " << warm_ms << " ms (checksum " << checksum << ")\n";
+    }
+
+    return 0;
+}
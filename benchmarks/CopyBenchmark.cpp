@@ -0,0 +1,54 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+#include "ArraySequence.hpp"
+#include "LazySequence.hpp"
+
+// Copies of a large ArraySequence that are only read afterwards: plain copy
+// construction, copy assignment and wrapping in a LazySequence.
+// Usage: copy_benchmark [count] [repetitions]
+
+template <typename F>
+static void measure(const char* name, int repetitions, F&& body)
+{
+    long long checksum = 0;
+
+    auto begin = std::chrono::steady_clock::now();
+    for (int r = 0; r < repetitions; ++r)
+        checksum += body(r);
+    auto end = std::chrono::steady_clock::now();
+
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count();
+    std::cout << name << ": " << us / repetitions << " us (checksum " << checksum << ")\n";
+}
+
+int main(int argc, char** argv)
+{
+    int count = argc > 1 ? std::atoi(argv[1]) : 5000000;
+    int repetitions = argc > 2 ? std::atoi(argv[2]) : 20;
+
+    ArraySequence<int> source(count);
+    for (int i = 0; i < count; ++i)
+        source[i] = i % 1000;
+
+    const ArraySequence<int>& readonly = source;
+
+    measure("copy constructor      ", repetitions, [&](int r) {
+        ArraySequence<int> copy(readonly);
+        return static_cast<long long>(copy.get(r));
+    });
+
+    ArraySequence<int> target;
+    measure("copy assignment       ", repetitions, [&](int r) {
+        target = readonly;
+        return static_cast<long long>(target.get(r));
+    });
+
+    measure("LazySequence::create  ", repetitions, [&](int r) {
+        auto lazy = LazySequence<int>::create(readonly);
+        return static_cast<long long>(lazy->get(static_cast<size_t>(r)));
+    });
+
+    return 0;
+}
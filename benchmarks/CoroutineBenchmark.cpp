@@ -0,0 +1,109 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+#include "ArraySequence.hpp"
+#include "CoroutineGenerator.hpp"
+#include "LazySequence.hpp"
+
+// The same sources written as Generator subclasses and as co_yield
+// coroutines, read to the end through a LazySequence in one request and
+// one element at a time: an array, a filter over it and a recurrence.
+// Needs -DSEQUENCE_COROUTINES=ON.
+// Usage: coroutine_benchmark [count] [repetitions]
+
+static Coroutine<long long> array_items(ArraySequence<long long> items)
+{
+    for (long long item : items.as_span())
+        co_yield item;
+}
+
+static Coroutine<long long> non_multiples(ArraySequence<long long> items, long long divisor)
+{
+    for (long long item : items.as_span())
+        if (item % divisor != 0)
+            co_yield item;
+}
+
+static Coroutine<long long> fibonacci()
+{
+    long long a = 0, b = 1;
+    while (true)
+    {
+        co_yield a;
+        b = a + b;
+        a = b - a;
+    }
+}
+
+template <typename F>
+static void measure(const char* name, int repetitions, F&& make)
+{
+    for (bool one_request : { true, false })
+    {
+        long long checksum = 0;
+
+        auto begin = std::chrono::steady_clock::now();
+        for (int r = 0; r < repetitions; ++r)
+        {
+            auto [lazy, length] = make();
+            if (one_request)
+                checksum += lazy->get(length - 1);
+            else
+                for (size_t i = 0; i < length; ++i)
+                    checksum += lazy->get_next();
+        }
+        auto end = std::chrono::steady_clock::now();
+
+        auto us = std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count();
+        std::cout << name << (one_request ? ", one get : " : ", get_next: ")
+                  << us / repetitions << " us (checksum " << checksum << ")\n";
+    }
+}
+
+int main(int argc, char** argv)
+{
+    int count = argc > 1 ? std::atoi(argv[1]) : 1000000;
+    int repetitions = argc > 2 ? std::atoi(argv[2]) : 5;
+
+    ArraySequence<long long> source(count);
+    for (int i = 0; i < count; ++i)
+        source[i] = i;
+
+    size_t kept = count - (count + 4) / 5;
+
+    ArraySequence<long long> start;
+    start.append(0);
+    start.append(1);
+    auto fib_rule = [](const ArraySequence<long long>& s) { return s[0] + s[1]; };
+
+    using Lazy = std::shared_ptr<LazySequence<long long>>;
+    auto with_length = [](Lazy lazy, size_t length) { return std::make_pair(lazy, length); };
+
+    measure("array,     virtual  ", repetitions, [&] {
+        return with_length(LazySequence<long long>::create(source), count);
+    });
+    measure("array,     coroutine", repetitions, [&] {
+        return with_length(LazySequence<long long>::create(
+            std::make_unique<Coroutine_Generator<long long>>(array_items(source))), count);
+    });
+
+    measure("where,     virtual  ", repetitions, [&] {
+        return with_length(LazySequence<long long>::create(source)->where(
+            [](long long x) { return x % 5 != 0; }), kept);
+    });
+    measure("where,     coroutine", repetitions, [&] {
+        return with_length(LazySequence<long long>::create(
+            std::make_unique<Coroutine_Generator<long long>>(non_multiples(source, 5))), kept);
+    });
+
+    measure("fibonacci, virtual  ", repetitions, [&] {
+        return with_length(LazySequence<long long>::create(start, 2, fib_rule), count);
+    });
+    measure("fibonacci, coroutine", repetitions, [&] {
+        return with_length(LazySequence<long long>::create(
+            std::make_unique<Coroutine_Generator<long long>>(fibonacci())), count);
+    });
+
+    return 0;
+}
@@ -0,0 +1,108 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory_resource>
+#include <new>
+
+#include "LazySequence.hpp"
+#include "ArraySequence.hpp"
+
+// 1-, 3- and 6-stage map/where chains over a materialized source, read to
+// the end in one request and one element at a time. Peak bytes count every
+// buffer the pipeline takes from its memory resource.
+// Usage: fusion_benchmark [count] [repetitions]
+
+class Peak_Resource : public std::pmr::memory_resource
+{
+public:
+    size_t live = 0;
+    size_t peak = 0;
+
+protected:
+    void* do_allocate(size_t bytes, size_t) override
+    {
+        live += bytes;
+        peak = live > peak ? live : peak;
+        if (void* ptr = std::malloc(bytes))
+            return ptr;
+        throw std::bad_alloc();
+    }
+
+    void do_deallocate(void* ptr, size_t bytes, size_t) override
+    {
+        live -= bytes;
+        std::free(ptr);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+    {
+        return this == &other;
+    }
+};
+
+// map, where, map, where, ... with stages in total
+static std::shared_ptr<LazySequence<long long>> build_chain(
+    const ArraySequence<long long>& source, int stages, std::pmr::memory_resource* resource)
+{
+    auto chain = LazySequence<long long>::create(source, resource);
+    for (int s = 0; s < stages; ++s)
+    {
+        if (s % 2 == 0)
+            chain = chain->map<long long>([](const long long& x) { return x * 3 + 1; });
+        else
+            chain = chain->where([](long long x) { return x % 5 != 0; });
+    }
+    return chain;
+}
+
+int main(int argc, char** argv)
+{
+    int count = argc > 1 ? std::atoi(argv[1]) : 1000000;
+    int repetitions = argc > 2 ? std::atoi(argv[2]) : 5;
+
+    ArraySequence<long long> source;
+    for (int i = 0; i < count; ++i)
+        source.append(i);
+
+    for (int stages : { 1, 3, 6 })
+    {
+        size_t length = 0;
+        {
+            auto chain = build_chain(source, stages, nullptr);
+            while (chain->has_next())
+            {
+                chain->get_next();
+                ++length;
+            }
+        }
+
+        for (bool one_request : { true, false })
+        {
+            Peak_Resource heap;
+            long long checksum = 0;
+
+            auto begin = std::chrono::steady_clock::now();
+            for (int r = 0; r < repetitions; ++r)
+            {
+                auto chain = build_chain(source, stages, &heap);
+                if (one_request)
+                {
+                    checksum += chain->get(length - 1);
+                }
+                else
+                {
+                    while (chain->has_next())
+                        checksum += chain->get_next();
+                }
+            }
+            auto end = std::chrono::steady_clock::now();
+
+            auto us = std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count();
+            std::cout << stages << " stages, " << (one_request ? "one get " : "get_next")
+                      << ": " << us / repetitions << " us, peak " << heap.peak << " bytes"
+                      << " (checksum " << checksum << ")\n";
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,55 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+#include "ArraySequence.hpp"
+
+// A tight numeric transform through the virtual map(std::function), the
+// templated map_to and the in-place transform.
+// Usage: map_benchmark [count] [repetitions]
+
+template <typename F>
+static void measure(const char* name, int repetitions, F&& body)
+{
+    double checksum = 0;
+
+    auto begin = std::chrono::steady_clock::now();
+    for (int r = 0; r < repetitions; ++r)
+        checksum += body();
+    auto end = std::chrono::steady_clock::now();
+
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count();
+    std::cout << name << ": " << us / repetitions << " us (checksum " << checksum << ")\n";
+}
+
+int main(int argc, char** argv)
+{
+    int count = argc > 1 ? std::atoi(argv[1]) : 10000000;
+    int repetitions = argc > 2 ? std::atoi(argv[2]) : 10;
+
+    ArraySequence<float> source(count);
+    for (int i = 0; i < count; ++i)
+        source[i] = static_cast<float>(i % 1000);
+
+    auto scale = [](float x) { return x * 1.5f + 2.0f; };
+
+    measure("map(std::function), new    ", repetitions, [&] {
+        ArraySequence<float>* mapped = source.map(scale);
+        double item = (*mapped)[count / 2 + 7];
+        delete mapped;
+        return item;
+    });
+
+    measure("map_to, by value           ", repetitions, [&] {
+        ArraySequence<float> mapped = source.map_to(scale);
+        return static_cast<double>(mapped[count / 2 + 7]);
+    });
+
+    ArraySequence<float> in_place(source);
+    measure("transform, in place        ", repetitions, [&] {
+        in_place.transform([](float x) { return x * 0.5f + 1.0f; });
+        return static_cast<double>(in_place[count / 2 + 7]);
+    });
+
+    return 0;
+}
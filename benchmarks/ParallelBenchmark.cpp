@@ -0,0 +1,72 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+#include "LazySequence.hpp"
+#include "ParallelOperations.hpp"
+
+// parallel_map / parallel_where / parallel_reduce and a LazySequence read
+// through map_parallel one element at a time, with an expensive
+// per-element function, at 1, 2, 4 and 8 threads.
+// Usage: parallel_benchmark [count] [work per element]
+
+static unsigned expensive(unsigned x, int rounds)
+{
+    for (int i = 0; i < rounds; ++i)
+        x = (x ^ (x >> 15)) * 2246822519u + 3266489917u;
+    return x;
+}
+
+template <typename F>
+static long long measure_ms(F&& body)
+{
+    auto begin = std::chrono::steady_clock::now();
+    body();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count();
+}
+
+int main(int argc, char** argv)
+{
+    int count = argc > 1 ? std::atoi(argv[1]) : 2000000;
+    int rounds = argc > 2 ? std::atoi(argv[2]) : 200;
+
+    ArraySequence<unsigned> source(count);
+    for (int i = 0; i < count; ++i)
+        source[i] = static_cast<unsigned>(i);
+
+    for (size_t threads : { 1, 2, 4, 8 })
+    {
+        ThreadPool pool(threads);
+        unsigned long long checksum = 0;
+
+        long long map_ms = measure_ms([&] {
+            auto mapped = parallel_map(source, [rounds](unsigned x) { return expensive(x, rounds); }, pool);
+            checksum += mapped[count / 2];
+        });
+
+        long long where_ms = measure_ms([&] {
+            auto kept = parallel_where(source, [rounds](unsigned x) { return expensive(x, rounds) % 3 == 0; }, pool);
+            checksum += kept.get_size();
+        });
+
+        long long reduce_ms = measure_ms([&] {
+            checksum += parallel_reduce(source, 0u, [rounds](unsigned acc, unsigned x) {
+                return acc + expensive(x, rounds);
+            }, pool);
+        });
+
+        long long lazy_ms = measure_ms([&] {
+            auto lazy = LazySequence<unsigned>::create(source)->map_parallel<unsigned>(
+                [rounds](const unsigned& x) { return expensive(x, rounds); }, 4096, pool);
+            while (lazy->has_next())
+                checksum += lazy->get_next();
+        });
+
+        std::cout << threads << " thread(s): map " << map_ms << " ms, where " << where_ms
+                  << " ms, reduce " << reduce_ms << " ms, lazy map " << lazy_ms
+                  << " ms (checksum " << checksum << ")\n";
+    }
+
+    return 0;
+}
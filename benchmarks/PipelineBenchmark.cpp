@@ -0,0 +1,119 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory_resource>
+#include <new>
+
+#include "LazySequence.hpp"
+#include "ArraySequence.hpp"
+
+// map -> where -> subsequence over a materialized source, run once with every
+// buffer taken from the heap and once out of a monotonic arena.
+// Usage: pipeline_benchmark [elements] [repetitions]
+
+static size_t global_allocations = 0;
+
+void* operator new(size_t size)
+{
+    ++global_allocations;
+    if (void* ptr = std::malloc(size))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+    std::free(ptr);
+}
+
+// Heap resource that counts its calls; bypasses operator new so the two
+// counters do not overlap.
+class Counting_Resource : public std::pmr::memory_resource
+{
+public:
+    size_t allocations = 0;
+
+protected:
+    void* do_allocate(size_t bytes, size_t) override
+    {
+        ++allocations;
+        if (void* ptr = std::malloc(bytes))
+            return ptr;
+        throw std::bad_alloc();
+    }
+
+    void do_deallocate(void* ptr, size_t, size_t) override
+    {
+        std::free(ptr);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+    {
+        return this == &other;
+    }
+};
+
+static long long run_chain(const ArraySequence<long long>& source, std::pmr::memory_resource* resource)
+{
+    int size = source.get_size();
+
+    auto result = LazySequence<long long>::create(source, resource)
+        ->map<long long>([](const long long& x) { return x * 7 + 1; })
+        ->where([](long long x) { return x % 3 != 0; })
+        ->get_subsequence(size / 4, size / 2);
+
+    long long sum = 0;
+    for (size_t i = 0; i <= static_cast<size_t>(size / 4); ++i)
+        sum += result->get(i);
+    return sum;
+}
+
+int main(int argc, char** argv)
+{
+    int count = argc > 1 ? std::atoi(argv[1]) : 100000;
+    int repetitions = argc > 2 ? std::atoi(argv[2]) : 50;
+
+    ArraySequence<long long> source;
+    for (int i = 0; i < count; ++i)
+        source.append(i);
+
+    for (bool use_arena : { false, true })
+    {
+        Counting_Resource heap;
+        size_t operator_new_before = global_allocations;
+        long long checksum = 0;
+
+        auto begin = std::chrono::steady_clock::now();
+
+        for (int r = 0; r < repetitions; ++r)
+        {
+            if (use_arena)
+            {
+                std::pmr::monotonic_buffer_resource arena(&heap);
+                checksum += run_chain(source, &arena);
+            }
+            else
+            {
+                checksum += run_chain(source, &heap);
+            }
+        }
+
+        auto end = std::chrono::steady_clock::now();
+        auto us = std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count();
+
+        size_t other = global_allocations - operator_new_before;
+
+        std::cout << (use_arena ? "arena: " : "heap:  ")
+                  << us / repetitions << " us/query, "
+                  << heap.allocations / repetitions << " buffer allocations/query, "
+                  << other / repetitions << " other allocations/query"
+                  << " (checksum " << checksum << ")\n";
+    }
+
+    return 0;
+}
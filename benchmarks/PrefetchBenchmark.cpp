@@ -0,0 +1,56 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "Generator.hpp"
+#include "LazySequence.hpp"
+#include "ReadOnlyStream.hpp"
+#include "SubstringFrequencyCounter.hpp"
+
+// SubstringFrequencyCounter::count over a file read through a LazySequence,
+// end to end from opening the file, with the generator run by the reader
+// and by a prefetching producer thread.
+// Usage: prefetch_benchmark [megabytes] [file]
+
+int main(int argc, char** argv)
+{
+    size_t megabytes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 64;
+    std::string path = argc > 2 ? argv[2] : "prefetch_benchmark.txt";
+
+    {
+        std::ofstream out(path, std::ios::binary);
+        std::string text = "lorem ipsum dolor ";
+        for (size_t written = 0; written < (megabytes << 20); written += text.size())
+            out << text;
+    }
+
+    for (bool prefetch : { false, true })
+    {
+        size_t found;
+
+        auto begin = std::chrono::steady_clock::now();
+        {
+            std::ifstream file(path, std::ios::binary);
+            auto lazy = std::make_shared<LazySequence<char>>(
+                std::make_unique<Stream_Generator<char>>(file));
+            lazy->set_retention(RetentionPolicy::release_below_cursor());
+            if (prefetch)
+                lazy->prefetch();
+
+            ReadOnlyStream<char> stream(lazy);
+            SubstringFrequencyCounter counter("ipsum");
+            found = counter.count(stream);
+        }
+        auto end = std::chrono::steady_clock::now();
+
+        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count();
+        std::cout << (prefetch ? "prefetch   " : "synchronous") << ": " << ms << " ms"
+                  << " (found " << found << ")\n";
+    }
+
+    std::remove(path.c_str());
+    return 0;
+}
@@ -0,0 +1,66 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+#include "LazySequence.hpp"
+#include "ArraySequence.hpp"
+
+// Fibonacci-style recurrence materialized up to `count` elements in one
+// request, stepped one element at a time while only a short window is
+// retained, and, declared linear, jumped to a far index.
+// Usage: recurrence_benchmark [count]
+
+template <typename F>
+static void measure(const char* name, F&& body)
+{
+    auto begin = std::chrono::steady_clock::now();
+    unsigned long long last = body();
+    auto end = std::chrono::steady_clock::now();
+
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count();
+    std::cout << name << ": " << us << " us (last = " << last << ")\n";
+}
+
+int main(int argc, char** argv)
+{
+    size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+
+    ArraySequence<unsigned long long> start;
+    start.append(0);
+    start.append(1);
+
+    ArraySequence<unsigned long long> coefficients;
+    coefficients.append(1);
+    coefficients.append(1);
+
+    auto fib = [](const ArraySequence<unsigned long long>& s) {
+        int n = s.get_size();
+        return s.get(n - 1) + s.get(n - 2);
+    };
+
+    measure("rule, one get          ", [&] {
+        auto lazy = LazySequence<unsigned long long>::create(start, 2, fib);
+        return lazy->get(count - 1);
+    });
+
+    measure("rule, get_next, window ", [&] {
+        auto lazy = LazySequence<unsigned long long>::create(start, 2, fib);
+        lazy->set_retention(RetentionPolicy::sliding_window(2));
+        unsigned long long last = 0;
+        for (size_t i = 2; i < count; ++i)
+            last = lazy->get_next();
+        return last;
+    });
+
+    measure("linear, get(count - 1) ", [&] {
+        auto lazy = LazySequence<unsigned long long>::create_linear(start, coefficients);
+        return lazy->get(count - 1);
+    });
+
+    measure("linear, jump to 10^12  ", [&] {
+        auto lazy = LazySequence<unsigned long long>::create_linear(start, coefficients);
+        return lazy->get(1000000000000ULL);
+    });
+
+    return 0;
+}
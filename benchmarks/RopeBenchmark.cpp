@@ -0,0 +1,58 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+
+#include "ArraySequence.hpp"
+#include "RopeSequence.hpp"
+
+// Splice-heavy editing of a large sequence: single-element inserts and
+// removes at random positions, block splices and subsequence extraction, on
+// ArraySequence and RopeSequence.
+// Usage: rope_benchmark [count] [edits]
+
+template <typename S>
+static void run(const char* name, int count, int edits)
+{
+    DynamicArray<int> items(count);
+    for (int i = 0; i < count; ++i)
+        items[i] = i;
+
+    auto begin = std::chrono::steady_clock::now();
+
+    S seq(items.get_data(), count);
+    S block(items.get_data(), 1000);
+
+    unsigned state = 1;
+    auto next = [&state](int bound) {
+        state = state * 1103515245u + 12345u;
+        return static_cast<int>((state >> 8) % static_cast<unsigned>(bound));
+    };
+
+    long long checksum = 0;
+    for (int e = 0; e < edits; ++e) {
+        int size = seq.get_size();
+        seq.insert_at(next(size), &block);
+        seq.remove(next(size));
+
+        int from = next(size / 2);
+        std::unique_ptr<S> sub(seq.get_subsequence(from, from + size / 4));
+        checksum += sub->get(sub->get_size() / 2) + seq.get(next(size));
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count();
+    std::cout << name << ": " << ms << " ms (size " << seq.get_size()
+              << ", checksum " << checksum << ")\n";
+}
+
+int main(int argc, char** argv)
+{
+    int count = argc > 1 ? std::atoi(argv[1]) : 2000000;
+    int edits = argc > 2 ? std::atoi(argv[2]) : 200;
+
+    run<ArraySequence<int>>("ArraySequence", count, edits);
+    run<RopeSequence<int>>("RopeSequence ", count, edits);
+
+    return 0;
+}
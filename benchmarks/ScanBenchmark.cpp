@@ -0,0 +1,101 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory_resource>
+#include <new>
+
+#include "Generator.hpp"
+#include "LazySequence.hpp"
+#include "ReadOnlyStream.hpp"
+#include "SubstringFrequencyCounter.hpp"
+
+// Sequential substring count over a synthetic character stream, keeping
+// every character and releasing the ones behind the reader.
+// Usage: scan_benchmark [megabytes]
+
+// Heap resource that tracks how many bytes are live at most.
+class Peak_Resource : public std::pmr::memory_resource
+{
+public:
+    size_t live = 0;
+    size_t peak = 0;
+
+protected:
+    void* do_allocate(size_t bytes, size_t) override
+    {
+        live += bytes;
+        peak = live > peak ? live : peak;
+        if (void* ptr = std::malloc(bytes))
+            return ptr;
+        throw std::bad_alloc();
+    }
+
+    void do_deallocate(void* ptr, size_t bytes, size_t) override
+    {
+        live -= bytes;
+        std::free(ptr);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+    {
+        return this == &other;
+    }
+};
+
+// "lorem ipsum dolor " repeated up to a given length, without holding it.
+class Text_Generator : public Generator<char>
+{
+private:
+    static constexpr const char* text = "lorem ipsum dolor ";
+    static constexpr size_t text_length = 18;
+
+    size_t position;
+    size_t length;
+
+public:
+    explicit Text_Generator(size_t length) : position(0), length(length) {}
+
+    char get_next() override
+    {
+        if (!has_next())
+            throw std::runtime_error("End of text");
+        return text[position++ % text_length];
+    }
+
+    bool has_next() override
+    {
+        return position < length;
+    }
+};
+
+int main(int argc, char** argv)
+{
+    size_t megabytes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 64;
+    size_t length = megabytes << 20;
+
+    for (bool release : { false, true })
+    {
+        Peak_Resource heap;
+        size_t found;
+
+        auto begin = std::chrono::steady_clock::now();
+        {
+            auto lazy = std::make_shared<LazySequence<char>>(
+                std::make_unique<Text_Generator>(length), &heap);
+            if (release)
+                lazy->set_retention(RetentionPolicy::release_below_cursor());
+
+            ReadOnlyStream<char> stream(lazy);
+            SubstringFrequencyCounter counter("ipsum");
+            found = counter.count(stream);
+        }
+        auto end = std::chrono::steady_clock::now();
+
+        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count();
+        std::cout << (release ? "release below cursor" : "unbounded           ")
+                  << ": " << ms << " ms, peak " << heap.peak << " bytes"
+                  << " (found " << found << ")\n";
+    }
+
+    return 0;
+}
@@ -0,0 +1,75 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+
+#include "ArraySequence.hpp"
+#include "LazySequence.hpp"
+#include "SliceSequence.hpp"
+
+// Cutting many overlapping read-only windows out of one large buffer: the
+// copying get_subsequence against SliceSequence and SharedSliceSequence,
+// and wrapping each window in a LazySequence.
+// Usage: slice_benchmark [count] [slices]
+
+template <typename F>
+static void measure(const char* name, F&& body)
+{
+    auto begin = std::chrono::steady_clock::now();
+    long long checksum = body();
+    auto end = std::chrono::steady_clock::now();
+
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count();
+    std::cout << name << ": " << us << " us (checksum " << checksum << ")\n";
+}
+
+int main(int argc, char** argv)
+{
+    int count = argc > 1 ? std::atoi(argv[1]) : 1000000;
+    int slices = argc > 2 ? std::atoi(argv[2]) : 2000;
+
+    auto source = std::make_shared<ArraySequence<int>>(count);
+    for (int i = 0; i < count; ++i)
+        (*source)[i] = i % 1000;
+
+    int width = count / 2;
+    int step = (count - width) / slices;
+
+    measure("get_subsequence (copy)   ", [&] {
+        long long checksum = 0;
+        for (int s = 0; s < slices; ++s) {
+            std::unique_ptr<ArraySequence<int>> part(source->get_subsequence(s * step, s * step + width - 1));
+            checksum += part->get(s % width);
+        }
+        return checksum;
+    });
+
+    measure("SliceSequence            ", [&] {
+        long long checksum = 0;
+        for (int s = 0; s < slices; ++s) {
+            SliceSequence<int> part(*source, s * step, s * step + width - 1);
+            checksum += part.get(s % width);
+        }
+        return checksum;
+    });
+
+    measure("SharedSliceSequence      ", [&] {
+        long long checksum = 0;
+        for (int s = 0; s < slices; ++s) {
+            SharedSliceSequence<int> part(source, s * step, s * step + width - 1);
+            checksum += part.get(s % width);
+        }
+        return checksum;
+    });
+
+    measure("LazySequence over shared ", [&] {
+        long long checksum = 0;
+        for (int s = 0; s < slices / 10; ++s) {
+            auto lazy = LazySequence<int>::create(SharedSliceSequence<int>(source, s * step, s * step + width - 1));
+            checksum += lazy->get(0);
+        }
+        return checksum;
+    });
+
+    return 0;
+}
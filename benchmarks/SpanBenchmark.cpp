@@ -0,0 +1,70 @@
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstdlib>
+#include <iostream>
+
+#include "ArraySequence.hpp"
+
+// sum/min/max over a Sequence<int>, element by element through the virtual
+// get() and directly over its contiguous view.
+// Usage: span_benchmark [count]
+
+struct Stats
+{
+    long long sum;
+    int min;
+    int max;
+};
+
+template <typename F>
+static void measure(const char* name, F&& body)
+{
+    auto begin = std::chrono::steady_clock::now();
+    Stats stats = body();
+    auto end = std::chrono::steady_clock::now();
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count();
+
+    std::cout << name << ": " << ms << " ms"
+              << " (sum " << stats.sum << ", min " << stats.min << ", max " << stats.max << ")\n";
+}
+
+int main(int argc, char** argv)
+{
+    int count = argc > 1 ? std::atoi(argv[1]) : 100000000;
+
+    ArraySequence<int> storage(count);
+    unsigned value = 12345;
+    for (int& item : storage)
+    {
+        value = value * 1103515245u + 12345u;
+        item = static_cast<int>((value >> 8) & 0xFFFF);
+    }
+
+    const Sequence<int>& seq = storage;
+
+    measure("virtual get()", [&] {
+        Stats stats{ 0, INT_MAX, INT_MIN };
+        for (int i = 0; i < seq.get_size(); ++i)
+        {
+            int item = seq.get(i);
+            stats.sum += item;
+            stats.min = std::min(stats.min, item);
+            stats.max = std::max(stats.max, item);
+        }
+        return stats;
+    });
+
+    measure("span view    ", [&] {
+        Stats stats{ 0, INT_MAX, INT_MIN };
+        for (int item : seq.as_span())
+        {
+            stats.sum += item;
+            stats.min = std::min(stats.min, item);
+            stats.max = std::max(stats.max, item);
+        }
+        return stats;
+    });
+
+    return 0;
+}
@@ -0,0 +1,85 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+#include "ArraySequence.hpp"
+#include "LazyPipeline.hpp"
+#include "LazySequence.hpp"
+
+// map -> where -> sum written by hand, as a LazyPipeline, as a LazySequence
+// chain read block by block and summed by its terminal operation, and as an
+// erased LazyPipeline.
+// Usage: static_pipeline_benchmark [count] [repetitions]
+
+template <typename F>
+static void measure(const char* name, int repetitions, F&& body)
+{
+    long long checksum = 0;
+
+    auto begin = std::chrono::steady_clock::now();
+    for (int r = 0; r < repetitions; ++r)
+        checksum += body();
+    auto end = std::chrono::steady_clock::now();
+
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count();
+    std::cout << name << ": " << us / repetitions << " us (checksum " << checksum << ")\n";
+}
+
+static long long sum_lazy(const std::shared_ptr<LazySequence<long long>>& lazy)
+{
+    long long total = 0;
+    Span<const long long> block;
+    for (size_t i = 0; !(block = lazy->materialize(i, 4096)).empty(); i += block.size())
+        for (long long item : block)
+            total += item;
+    return total;
+}
+
+int main(int argc, char** argv)
+{
+    int count = argc > 1 ? std::atoi(argv[1]) : 10000000;
+    int repetitions = argc > 2 ? std::atoi(argv[2]) : 10;
+
+    ArraySequence<long long> source(count);
+    for (int i = 0; i < count; ++i)
+        source[i] = i;
+
+    auto scale = [](long long x) { return x * 3 + 1; };
+    auto keep = [](long long x) { return x % 5 != 0; };
+
+    measure("hand-written loop  ", repetitions, [&] {
+        const long long* data = std::as_const(source).get_data();
+        long long total = 0;
+        for (int i = 0; i < count; ++i)
+        {
+            long long x = scale(data[i]);
+            if (keep(x))
+                total += x;
+        }
+        return total;
+    });
+
+    measure("LazyPipeline       ", repetitions, [&] {
+        return make_pipeline(source).map(scale).where(keep).sum();
+    });
+
+    measure("LazySequence chain ", repetitions, [&] {
+        auto lazy = LazySequence<long long>::create(source)
+            ->map<long long>(scale)
+            ->where(keep);
+        return sum_lazy(lazy);
+    });
+
+    measure("LazySequence sum() ", repetitions, [&] {
+        return LazySequence<long long>::create(source)
+            ->map<long long>(scale)
+            ->where(keep)
+            ->sum();
+    });
+
+    measure("erased LazyPipeline", repetitions, [&] {
+        return sum_lazy(make_pipeline(source).map(scale).where(keep).erase());
+    });
+
+    return 0;
+}
@@ -5,63 +5,113 @@
 // constructors
 
 template <typename T>
-LazySequence<T>::LazySequence()
-    : materialized_data(std::make_unique<ArraySequence<T>>())
+LazySequence<T>::LazySequence(std::pmr::memory_resource* resource)
+    : resource(resource),
+      materialized_data(resource),
+      retention(RetentionPolicy::unbounded()),
+      erased(0),
+      released(0),
+      cursor(0),
+      batch(resource)
 {}
 
 template <typename T>
 LazySequence<T>::LazySequence(
     const Sequence<T>& start_sequence,
     size_t,
-    std::function<T(const Sequence<T>&)>
+    std::function<T(const Sequence<T>&)>,
+    std::pmr::memory_resource* resource
 )
-    : materialized_data(std::make_unique<ArraySequence<T>>(start_sequence))
+    : resource(resource),
+      materialized_data(start_sequence, resource),
+      retention(RetentionPolicy::unbounded()),
+      erased(0),
+      released(0),
+      cursor(0),
+      batch(resource)
 {}
 
 template <typename T>
-LazySequence<T>::LazySequence(const Sequence<T>& sequence)
+LazySequence<T>::LazySequence(
+    const Sequence<T>& sequence,
+    std::pmr::memory_resource* resource
+)
+    : resource(resource),
+      materialized_data(resource),
+      retention(RetentionPolicy::unbounded()),
+      erased(0),
+      released(0),
+      cursor(0),
+      batch(resource)
 {
-    materialized_data = std::make_unique<ArraySequence<T>>();
-    generator = std::make_unique<Sequence_Generator<T>>(sequence);
+    generator = std::make_unique<Sequence_Generator<T>>(sequence, 0, resource);
 }
 
 template <typename T>
-LazySequence<T>::LazySequence(std::unique_ptr<Generator<T>>&& gen)
+LazySequence<T>::LazySequence(
+    std::unique_ptr<Generator<T>>&& gen,
+    std::pmr::memory_resource* resource
+)
+    : resource(resource),
+      materialized_data(resource),
+      retention(RetentionPolicy::unbounded()),
+      erased(0),
+      released(0),
+      cursor(0),
+      batch(resource)
 {
-    materialized_data = std::make_unique<ArraySequence<T>>();
     generator = std::move(gen);
 }
 
+template <typename T>
+template <typename... Args>
+std::shared_ptr<LazySequence<T>> LazySequence<T>::allocate(
+    std::pmr::memory_resource* resource,
+    Args&&... args
+)
+{
+    if (!resource)
+        return std::make_shared<LazySequence<T>>(std::forward<Args>(args)..., resource);
+
+    return std::allocate_shared<LazySequence<T>>(
+        std::pmr::polymorphic_allocator<LazySequence<T>>(resource),
+        std::forward<Args>(args)..., resource
+    );
+}
+
 // init
 
 template <typename T>
 void LazySequence<T>::init_function_generator(
     size_t arity,
-    std::function<T(const Sequence<T>&)> rule
+    std::function<T(const ArraySequence<T>&)> rule
 )
 {
     generator = std::make_unique<Function_Generator<T>>(
-        this->shared_from_this(), arity, rule
+        materialized_data, arity, rule
     );
 }
 
 // create
 
 template <typename T>
-std::shared_ptr<LazySequence<T>> LazySequence<T>::create()
+std::shared_ptr<LazySequence<T>> LazySequence<T>::create(
+    std::pmr::memory_resource* resource
+)
 {
-    return std::shared_ptr<LazySequence<T>>(new LazySequence<T>());
+    return allocate(resource);
 }
 
 template <typename T>
 std::shared_ptr<LazySequence<T>> LazySequence<T>::create(
     const Sequence<T>& start_sequence,
     size_t arity,
-    std::function<T(const ArraySequence<T>&)> rule
+    std::function<T(const ArraySequence<T>&)> rule,
+    std::pmr::memory_resource* resource
 )
 {
-    auto l = std::shared_ptr<LazySequence<T>>(
-        new LazySequence<T>(start_sequence, arity, rule)
+    auto l = allocate(
+        resource, start_sequence, arity, std::function<T(const Sequence<T>&)>()
     );
     l->init_function_generator(arity, rule);
     return l;
@@ -69,63 +119,283 @@ std::shared_ptr<LazySequence<T>> LazySequence<T>::create(
 
 template <typename T>
 std::shared_ptr<LazySequence<T>> LazySequence<T>::create(
-    std::unique_ptr<Generator<T>>&& gen
+    std::unique_ptr<Generator<T>>&& gen,
+    std::pmr::memory_resource* resource
 )
 {
-    return std::shared_ptr<LazySequence<T>>(
-        new LazySequence<T>(std::move(gen))
-    );
+    return allocate(resource, std::move(gen));
 }
 
 template <typename T>
 std::shared_ptr<LazySequence<T>> LazySequence<T>::create(
-    const Sequence<T>& sequence
+    const Sequence<T>& sequence,
+    std::pmr::memory_resource* resource
+)
+{
+    return allocate(resource, sequence);
+}
+
+template <typename T>
+std::shared_ptr<LazySequence<T>> LazySequence<T>::create_linear(
+    const Sequence<T>& start_sequence,
+    const Sequence<T>& coefficients,
+    std::pmr::memory_resource* resource
 )
 {
-    return std::shared_ptr<LazySequence<T>>(
-        new LazySequence<T>(sequence)
+    auto l = allocate(
+        resource, start_sequence, coefficients.get_size(), std::function<T(const Sequence<T>&)>()
     );
+    l->generator = std::make_unique<Linear_Recurrence_Generator<T>>(start_sequence, coefficients);
+    return l;
+}
+
+template <typename T>
+std::pmr::memory_resource* LazySequence<T>::get_memory_resource() const
+{
+    return resource;
 }
 
 // get/has
 
+template <typename T>
+void LazySequence<T>::generate_until(size_t count)
+{
+    size_t size = get_materialized_count();
+    if (size >= count || !generator)
+        return;
+
+    release_retired();
+    reserve_for(count);
+
+    // a single element is cheaper through the plain virtual pair
+    if (count - size == 1)
+    {
+        if (generator->has_next())
+            materialized_data.append(generator->get_next());
+        return;
+    }
+
+    size_t block = std::min(count - size, batch_size);
+    if (static_cast<size_t>(batch.get_size()) < block)
+        batch.resize(static_cast<int>(block));
+
+    while (size < count)
+    {
+        size_t wanted = std::min(count - size, batch_size);
+        size_t produced = generator->next_batch(batch.get_data(), wanted);
+        if (produced == 0)
+            break;
+
+        materialized_data.append_range(batch.get_data(), static_cast<int>(produced));
+        size += produced;
+    }
+}
+
+// Grows the cache no further than the generator's hint says it can get;
+// a request reaching the whole of an exact length allocates it at once.
+template <typename T>
+void LazySequence<T>::reserve_for(size_t count)
+{
+    if (retention.mode != RetentionPolicy::Mode::unbounded)
+        return;
+
+    size_t needed = count - erased;
+    size_t capacity = static_cast<size_t>(materialized_data.get_capacity());
+    if (needed <= capacity)
+        return;
+
+    SizeHint left = generator->size_hint();
+    if (!left.is_known())
+        return;
+
+    size_t final_size = materialized_data.get_size() + left.value;
+    size_t target = std::min(final_size, std::max(needed, 2 * capacity));
+    if (target > capacity)
+        materialized_data.reserve(static_cast<int>(target));
+}
+
+// Applies the policy to what earlier requests left behind; runs at the
+// start of each request, so whatever a request generates stays until the
+// next one.
+template <typename T>
+void LazySequence<T>::advance_released()
+{
+    if (retention.mode == RetentionPolicy::Mode::unbounded)
+        return;
+
+    size_t end = get_materialized_count();
+    size_t keep_from = released;
+
+    if (retention.mode == RetentionPolicy::Mode::sliding_window && end > retention.window)
+        keep_from = end - retention.window;
+    else if (retention.mode == RetentionPolicy::Mode::release_below_cursor)
+        keep_from = std::min(cursor, end);
+
+    released = std::max(released, keep_from);
+}
+
+// Runs before generating, so spans handed out by materialize() stay valid
+// until the next request that generates.
+template <typename T>
+void LazySequence<T>::release_retired()
+{
+    advance_released();
+
+    size_t end = get_materialized_count();
+    size_t dead = released - erased;
+    if (dead > 0 && dead >= std::max(release_slack, end - released))
+    {
+        materialized_data.erase_range(0, static_cast<int>(dead) - 1);
+        erased = released;
+    }
+}
+
+template <typename T>
+void LazySequence<T>::check_retained(size_t index)
+{
+    advance_released();
+    if (index < released)
+        throw std::runtime_error("Element was released by the retention policy");
+}
+
 template <typename T>
 T LazySequence<T>::get(size_t index)
 {
-    while (materialized_data->get_size() <= index &&
-           generator && generator->has_next())
+    check_retained(index);
+    cursor = std::max(cursor, index);
+
+    size_t count = get_materialized_count();
+    if (generator && index >= count + jump_distance)
     {
-        materialized_data->append(generator->get_next());
+        if (std::optional<T> item = generator->jump(index - count))
+            return *item;
     }
 
-    if (materialized_data->get_size() <= index)
+    generate_until(index + 1);
+
+    if (get_materialized_count() <= index)
         throw std::runtime_error("Index beyond possible generation");
 
-    return materialized_data->get(index);
+    return std::as_const(materialized_data)[static_cast<int>(index - erased)];
+}
+
+template <typename T>
+Span<const T> LazySequence<T>::materialize(size_t from, size_t count)
+{
+    check_retained(from);
+    cursor = std::max(cursor, from);
+
+    generate_until(from + count);
+
+    size_t size = get_materialized_count();
+    if (from >= size)
+        return Span<const T>();
+
+    return std::as_const(materialized_data).as_span().subspan(from - erased, std::min(count, size - from));
+}
+
+template <typename T>
+std::function<size_t(T*, size_t)> LazySequence<T>::fork()
+{
+    if (generator && get_materialized_count() == 0)
+    {
+        if (auto source = generator->fork())
+            return source;
+    }
+
+    return [self = this->shared_from_this(), index = size_t(0), source = Batch_Source<T>()]
+        (T* out, size_t max) mutable -> size_t {
+        if (!source && !out && self->generator && index + max > self->get_materialized_count())
+        {
+            // a skip past the cache goes on in a fork of the generator
+            // instead of caching everything it passes over
+            source = self->generator->fork();
+            for (size_t skipped = 0; source && skipped < index;)
+            {
+                size_t passed = source(nullptr, index - skipped);
+                if (passed == 0)
+                    break;
+                skipped += passed;
+            }
+        }
+
+        if (source)
+            return source(out, max);
+
+        Span<const T> items = self->materialize(index, max);
+        if (out)
+            std::copy(items.begin(), items.end(), out);
+        index += items.size();
+        return items.size();
+    };
 }
 
 template <typename T>
 T LazySequence<T>::get_next()
 {
-    return get(materialized_data->get_size());
+    return get(get_materialized_count());
 }
 
 template <typename T>
 T LazySequence<T>::get_first_materialized() const
 {
-    return materialized_data->get_first();
+    if (released == get_materialized_count())
+        throw std::runtime_error("Sequence is empty");
+
+    return materialized_data[static_cast<int>(released - erased)];
 }
 
 template <typename T>
 T LazySequence<T>::get_last_materialized() const
 {
-    return materialized_data->get_last();
+    return materialized_data.get_last();
 }
 
 template <typename T>
 size_t LazySequence<T>::get_materialized_count() const
 {
-    return materialized_data->get_size();
+    return erased + materialized_data.get_size();
+}
+
+template <typename T>
+SizeHint LazySequence<T>::size_hint() const
+{
+    SizeHint done = SizeHint::exact(get_materialized_count());
+    return generator ? done + generator->size_hint() : done;
+}
+
+template <typename T>
+std::optional<size_t> LazySequence<T>::size() const
+{
+    SizeHint hint = size_hint();
+    if (!hint.is_exact())
+        return std::nullopt;
+    return hint.value;
+}
+
+template <typename T>
+size_t LazySequence<T>::get_released_count() const
+{
+    return released;
+}
+
+template <typename T>
+void LazySequence<T>::set_retention(RetentionPolicy policy)
+{
+    retention = policy;
+}
+
+template <typename T>
+RetentionPolicy LazySequence<T>::get_retention() const
+{
+    return retention;
+}
+
+template <typename T>
+void LazySequence<T>::prefetch(size_t capacity)
+{
+    if (generator)
+        generator = std::make_unique<Prefetch_Generator<T>>(std::move(generator), capacity);
 }
 
 template <typename T>
@@ -143,7 +413,7 @@ std::shared_ptr<LazySequence<T>> LazySequence<T>::append(
     auto gen = std::make_unique<Concat_Generator<T>>(
         this->shared_from_this(), items
     );
-    return std::make_shared<LazySequence<T>>(std::move(gen));
+    return allocate(resource, std::move(gen));
 }
 
 template <typename T>
@@ -153,7 +423,7 @@ std::shared_ptr<LazySequence<T>> LazySequence<T>::prepend(
     auto gen = std::make_unique<Concat_Generator<T>>(
         items, this->shared_from_this()
     );
-    return std::make_shared<LazySequence<T>>(std::move(gen));
+    return allocate(resource, std::move(gen));
 }
 
 template <typename T>
@@ -164,7 +434,7 @@ std::shared_ptr<LazySequence<T>> LazySequence<T>::insert_at(
     auto gen = std::make_unique<Insert_Generator<T>>(
         this->shared_from_this(), items, insert_index
     );
-    return std::make_shared<LazySequence<T>>(std::move(gen));
+    return allocate(resource, std::move(gen));
 }
 
 template <typename T>
@@ -175,7 +445,7 @@ std::shared_ptr<LazySequence<T>> LazySequence<T>::get_subsequence(
     auto gen = std::make_unique<Subsequence_Generator<T>>(
         this->shared_from_this(), from_index, to_index
     );
-    return std::make_shared<LazySequence<T>>(std::move(gen));
+    return allocate(resource, std::move(gen));
 }
 
 template <typename T>
@@ -186,7 +456,20 @@ std::shared_ptr<LazySequence<T2>> LazySequence<T>::map(
     auto gen = std::make_unique<Map_Generator<T2, T>>(
         this->shared_from_this(), func
     );
-    return std::make_shared<LazySequence<T2>>(std::move(gen));
+    return LazySequence<T2>::allocate(resource, std::move(gen));
+}
+
+template <typename T>
+template <typename T2>
+std::shared_ptr<LazySequence<T2>> LazySequence<T>::map_parallel(
+    std::function<T2(const T&)> func,
+    size_t lookahead,
+    ThreadPool& pool)
+{
+    auto gen = std::make_unique<Parallel_Map_Generator<T2, T>>(
+        this->shared_from_this(), func, lookahead, pool
+    );
+    return LazySequence<T2>::allocate(resource, std::move(gen));
 }
 
 template <typename T>
@@ -196,14 +479,171 @@ std::shared_ptr<LazySequence<T>> LazySequence<T>::where(
     auto gen = std::make_unique<Where_Generator<T>>(
         this->shared_from_this(), func
     );
-    return std::make_shared<LazySequence<T>>(std::move(gen));
+    return allocate(resource, std::move(gen));
 }
 
 template <typename T>
 std::shared_ptr<LazySequence<T>> LazySequence<T>::set_generator(
     std::unique_ptr<Generator<T>> generator)
 {
-    return std::make_shared<LazySequence<T>>(std::move(generator));
+    return allocate(resource, std::move(generator));
+}
+
+// terminal operations
+
+// Marks everything up to count elements past the current end as used up,
+// once the generator has produced them without storing them.
+template <typename T>
+void LazySequence<T>::release_drained(size_t count)
+{
+    size_t end = get_materialized_count() + count;
+
+    int size = materialized_data.get_size();
+    if (size > 0)
+        materialized_data.erase_range(0, size - 1);
+
+    erased = end;
+    released = end;
+}
+
+// Calls visit on each element until it returns false; returns whether it
+// ran to the end.
+template <typename T>
+template <typename F>
+bool LazySequence<T>::drain(F&& visit)
+{
+    Batch_Source<T> source = generator ? generator->fork() : Batch_Source<T>();
+    bool consumes = generator && !source;
+
+    // the cache covers the start unless part of it was released, in which
+    // case a fork starts over and a drained generator cannot
+    size_t cached = 0;
+    if (released == 0)
+    {
+        for (const T& item : materialized_data.as_span())
+            if (!visit(item))
+                return false;
+        cached = materialized_data.get_size();
+    }
+    else if (consumes)
+    {
+        throw std::runtime_error("Element was released by the retention policy");
+    }
+
+    if (!generator)
+        return true;
+
+    // not the shared batch: visit may read this sequence
+    DynamicArray<T> scratch(static_cast<int>(batch_size), resource);
+    T* block = scratch.get_data();
+
+    if (source)
+    {
+        while (cached > 0)
+        {
+            size_t skipped = source(nullptr, cached);
+            if (skipped == 0)
+                return true;
+            cached -= skipped;
+        }
+    }
+
+    while (true)
+    {
+        size_t produced = source ? source(block, batch_size) : generator->next_batch(block, batch_size);
+        if (produced == 0)
+            return true;
+
+        if (consumes)
+            release_drained(produced);
+
+        for (size_t i = 0; i < produced; i++)
+            if (!visit(block[i]))
+                return false;
+    }
+}
+
+template <typename T>
+template <typename U, typename Op>
+U LazySequence<T>::fold(U initial, Op&& op)
+{
+    drain([&](const T& item) {
+        initial = op(std::move(initial), item);
+        return true;
+    });
+    return initial;
+}
+
+template <typename T>
+template <typename Op>
+T LazySequence<T>::reduce(Op&& op)
+{
+    std::optional<T> result;
+    drain([&](const T& item) {
+        result = result ? op(std::move(*result), item) : item;
+        return true;
+    });
+
+    if (!result)
+        throw std::runtime_error("Sequence is empty");
+    return std::move(*result);
+}
+
+// Free when the length is known exactly.
+template <typename T>
+size_t LazySequence<T>::count()
+{
+    if (std::optional<size_t> length = size())
+        return *length;
+
+    size_t total = 0;
+    drain([&](const T&) {
+        ++total;
+        return true;
+    });
+    return total;
+}
+
+template <typename T>
+T LazySequence<T>::sum()
+{
+    return fold(T(), [](T total, const T& item) { return total + item; });
+}
+
+template <typename T>
+T LazySequence<T>::min()
+{
+    return reduce([](T best, const T& item) { return item < best ? item : best; });
+}
+
+template <typename T>
+T LazySequence<T>::max()
+{
+    return reduce([](T best, const T& item) { return best < item ? item : best; });
+}
+
+template <typename T>
+template <typename P>
+bool LazySequence<T>::any_of(P&& predicate)
+{
+    return !drain([&](const T& item) { return !predicate(item); });
+}
+
+template <typename T>
+template <typename P>
+bool LazySequence<T>::all_of(P&& predicate)
+{
+    return drain([&](const T& item) { return static_cast<bool>(predicate(item)); });
+}
+
+template <typename T>
+template <typename F>
+void LazySequence<T>::for_each(F&& func)
+{
+    drain([&](const T& item) {
+        func(item);
+        return true;
+    });
 }
 
 
@@ -55,6 +55,7 @@ int main()
 
                 auto gen = std::make_unique<Stream_Generator<char>>(buffer);
                 auto lazy = std::make_shared<LazySequence<char>>(std::move(gen));
+                lazy->set_retention(RetentionPolicy::release_below_cursor());
                 ReadOnlyStream<char> stream(lazy);
 
                 std::cout << "Результат: " << counter.count(stream) << "\n";
@@ -71,6 +72,7 @@ int main()
 
                 auto gen = std::make_unique<Stream_Generator<char>>(file);
                 auto lazy = std::make_shared<LazySequence<char>>(std::move(gen));
+                lazy->set_retention(RetentionPolicy::release_below_cursor());
                 ReadOnlyStream<char> stream(lazy);
 
                 std::cout << "Результат: " << counter.count(stream) << "\n";
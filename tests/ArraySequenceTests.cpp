@@ -0,0 +1,229 @@
+#include <gtest/gtest.h>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <utility>
+#include "ArraySequence.hpp"
+#include "SmallArraySequence.hpp"
+
+TEST(ArraySequence, RemoveShiftsTail) {
+    ArraySequence<int> seq;
+    for (int i = 0; i < 5; ++i)
+        seq.append(i);
+
+    seq.remove(1);
+
+    EXPECT_EQ(seq.get_size(), 4);
+    EXPECT_EQ(seq.get(0), 0);
+    EXPECT_EQ(seq.get(1), 2);
+    EXPECT_EQ(seq.get(3), 4);
+}
+
+TEST(SmallArraySequence, SpillsToHeapPastInlineCapacity) {
+    SmallArraySequence<std::string, 2> seq;
+    seq.append("a");
+    seq.append("b");
+    seq.append("c");
+    seq.prepend("z");
+
+    EXPECT_EQ(seq.get_size(), 4);
+    EXPECT_EQ(seq.get(0), "z");
+    EXPECT_EQ(seq.get(3), "c");
+
+    seq.reset();
+    seq.append("d");
+    EXPECT_EQ(seq.get_size(), 1);
+    EXPECT_EQ(seq.get_first(), "d");
+}
+
+TEST(SmallArraySequence, CopyAndMoveKeepElements) {
+    SmallArraySequence<std::string, 4> small;
+    small.append("x");
+    small.append("y");
+
+    SmallArraySequence<std::string, 4> copy(small);
+    SmallArraySequence<std::string, 4> moved(std::move(small));
+    ArraySequence<std::string> plain(std::move(moved));
+
+    EXPECT_EQ(copy.get_size(), 2);
+    EXPECT_EQ(copy.get(1), "y");
+    EXPECT_EQ(plain.get_size(), 2);
+    EXPECT_EQ(plain.get(0), "x");
+    EXPECT_EQ(moved.get_size(), 0);
+}
+
+TEST(SmallArraySequence, BindsToArraySequenceReference) {
+    SmallArraySequence<int, 3> args(3);
+    args.set(0, 1);
+    args.set(1, 2);
+    args.set(2, 3);
+
+    auto sum = [](const ArraySequence<int>& s) {
+        return s.get(0) + s.get(1) + s.get(2);
+    };
+
+    EXPECT_EQ(sum(args), 6);
+}
+
+TEST(ArraySequence, InsertAtFrontKeepsOrder) {
+    ArraySequence<int> seq;
+    seq.append(3);
+    seq.append(4);
+
+    ArraySequence<int> head;
+    head.append(1);
+    head.append(2);
+
+    seq.insert_at(0, &head);
+    seq.prepend(0);
+
+    EXPECT_EQ(seq.get_size(), 5);
+    for (int i = 0; i < 5; ++i)
+        EXPECT_EQ(seq.get(i), i);
+}
+
+TEST(ArraySequence, BulkRangeOperations) {
+    int items[] = { 10, 11, 12 };
+
+    ArraySequence<int> seq;
+    seq.reserve(16);
+    seq.append_range(items, 3);
+    seq.insert_range(1, items, 2);
+    seq.erase_range(0, 1);
+
+    int expected[] = { 11, 11, 12 };
+    ASSERT_EQ(seq.get_size(), 3);
+    for (int i = 0; i < 3; ++i)
+        EXPECT_EQ(seq.get(i), expected[i]);
+
+    EXPECT_THROW(seq.erase_range(2, 3), std::out_of_range);
+}
+
+TEST(ArraySequence, InsertAtMiddleAndSelf) {
+    ArraySequence<std::string> seq;
+    seq.append("a");
+    seq.append("d");
+
+    ArraySequence<std::string> mid;
+    mid.append("b");
+    mid.append("c");
+
+    seq.insert_at(1, &mid);
+    seq.insert_at(4, &seq);
+
+    std::string joined;
+    for (int i = 0; i < seq.get_size(); ++i)
+        joined += seq.get(i);
+
+    EXPECT_EQ(joined, "abcdabcd");
+
+    ArraySequence<std::string> copy(static_cast<const Sequence<std::string>&>(seq));
+    EXPECT_EQ(copy.get_size(), 8);
+    EXPECT_EQ(copy.get_last(), "d");
+}
+
+TEST(ArraySequence, ContiguousViewThroughSequence) {
+    ArraySequence<int> storage;
+    for (int i = 1; i <= 4; ++i)
+        storage.append(i);
+
+    const Sequence<int>& seq = storage;
+    Span<const int> view = seq.as_span();
+
+    ASSERT_NE(view.data(), nullptr);
+    EXPECT_EQ(view.size(), 4u);
+    EXPECT_EQ(std::accumulate(view.begin(), view.end(), 0), 10);
+
+    for (int& item : storage)
+        item *= 2;
+
+    EXPECT_EQ(seq.get(3), 8);
+    EXPECT_EQ(view.subspan(1, 2)[1], 6);
+}
+
+TEST(ArraySequence, CheckedAndUncheckedAccessAgree) {
+    ArraySequence<int> seq(3);
+    seq[0] = 5;
+    seq[2] = 7;
+
+    EXPECT_EQ(seq.get(0), 5);
+    EXPECT_EQ(seq[2], seq.get(2));
+    EXPECT_THROW(seq.get(3), std::out_of_range);
+    EXPECT_THROW(seq.set(-1, 0), std::out_of_range);
+}
+
+TEST(ArraySequence, MapToReturnsNewElementType) {
+    ArraySequence<int> seq;
+    for (int i = 0; i < 4; ++i)
+        seq.append(i);
+
+    ArraySequence<std::string> names = seq.map_to([](int x) { return std::to_string(x * 10); });
+    std::unique_ptr<ArraySequence<int>> doubled(seq.map([](int x) { return x * 2; }));
+
+    ASSERT_EQ(names.get_size(), 4);
+    EXPECT_EQ(names[3], "30");
+    EXPECT_EQ(doubled->get(3), 6);
+    EXPECT_EQ(seq[3], 3);
+}
+
+TEST(ArraySequence, TransformReusesStorage) {
+    ArraySequence<int> seq;
+    for (int i = 0; i < 100; ++i)
+        seq.append(i);
+
+    const int* storage = seq.get_data();
+    seq.transform([](int x) { return x * x; })->transform([](int x) { return x + 1; });
+
+    EXPECT_EQ(seq.get_data(), storage);
+    EXPECT_EQ(seq[9], 82);
+}
+
+TEST(ArraySequence, CopiesShareUntilWritten) {
+    ArraySequence<int> original;
+    for (int i = 0; i < 8; ++i)
+        original.append(i);
+
+    const ArraySequence<int> copy(original);
+    ArraySequence<int> assigned;
+    assigned = copy;
+
+    EXPECT_EQ(copy.get_data(), std::as_const(original).get_data());
+    EXPECT_EQ(assigned.as_span().data(), copy.as_span().data());
+
+    original[0] = 100;
+    assigned.remove(7);
+
+    EXPECT_EQ(original.get(0), 100);
+    EXPECT_EQ(copy.get(0), 0);
+    EXPECT_EQ(copy.get_size(), 8);
+    EXPECT_EQ(assigned.get_size(), 7);
+    EXPECT_EQ(assigned.get(0), 0);
+}
+
+TEST(ArraySequence, WritesThroughSubscriptStayInTheirCopy) {
+    ArraySequence<int> original;
+    for (int i = 0; i < 8; ++i)
+        original.append(i);
+
+    ArraySequence<int> copy(original);
+    original[0] = 99;
+    copy[1] = 77;
+
+    EXPECT_EQ(original.get(0), 99);
+    EXPECT_EQ(original.get(1), 1);
+    EXPECT_EQ(copy.get(0), 0);
+    EXPECT_EQ(copy.get(1), 77);
+}
+
+TEST(ArraySequence, ConstReadsKeepStorageShared) {
+    ArraySequence<int> original;
+    for (int i = 0; i < 8; ++i)
+        original.append(i);
+
+    const ArraySequence<int> copy(original);
+    EXPECT_EQ(copy.get(3), 3);
+    EXPECT_EQ(copy[4], 4);
+    EXPECT_EQ(copy.as_span().size(), 8u);
+
+    EXPECT_EQ(copy.get_data(), std::as_const(original).get_data());
+}
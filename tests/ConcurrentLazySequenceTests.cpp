@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "ConcurrentLazySequence.hpp"
+
+static unsigned long long lcg(unsigned long long x)
+{
+    return x * 6364136223846793005ULL + 1442695040888963407ULL;
+}
+
+TEST(ConcurrentLazySequence, ReadersShareOneGeneration) {
+    const size_t count = 200000;
+    const int threads = 8;
+
+    std::vector<unsigned long long> expected(count);
+    expected[0] = 1;
+    for (size_t i = 1; i < count; ++i)
+        expected[i] = lcg(expected[i - 1]);
+
+    ArraySequence<unsigned long long> start;
+    start.append(1);
+
+    std::atomic<size_t> rule_calls(0);
+    auto lazy = ConcurrentLazySequence<unsigned long long>::create(start, 1,
+        [&rule_calls](const ArraySequence<unsigned long long>& s) {
+            rule_calls.fetch_add(1, std::memory_order_relaxed);
+            return lcg(s[0]);
+        });
+
+    // every thread strides through the indices from its own offset, so
+    // extensions and lock-free reads of fresh chunks interleave
+    std::atomic<size_t> mismatches(0);
+    std::vector<std::thread> readers;
+    for (int t = 0; t < threads; ++t)
+    {
+        readers.emplace_back([&, t] {
+            for (size_t i = t; i < count; i += 1 + t)
+                if (lazy->get(i) != expected[i])
+                    mismatches.fetch_add(1, std::memory_order_relaxed);
+            for (long long i = count - 1 - t; i >= 0; i -= 97)
+                if (lazy->get(i) != expected[i])
+                    mismatches.fetch_add(1, std::memory_order_relaxed);
+        });
+    }
+    for (auto& reader : readers)
+        reader.join();
+
+    EXPECT_EQ(mismatches.load(), 0u);
+    EXPECT_EQ(lazy->get_materialized_count(), count);
+    EXPECT_EQ(rule_calls.load(), count - 1);
+}
+
+TEST(ConcurrentLazySequence, FiniteSourceEndsForEveryReader) {
+    ArraySequence<int> numbers;
+    for (int i = 0; i < 5000; ++i)
+        numbers.append(i * 2);
+
+    ConcurrentLazySequence<int> lazy(std::make_unique<Sequence_Generator<int>>(numbers));
+
+    std::atomic<int> beyond(0);
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; ++t)
+    {
+        readers.emplace_back([&] {
+            for (int i = 0; i < 6000; ++i)
+            {
+                try
+                {
+                    if (lazy.get(i) != i * 2)
+                        beyond.fetch_add(1000000);
+                }
+                catch (const std::runtime_error&)
+                {
+                    beyond.fetch_add(1);
+                }
+            }
+        });
+    }
+    for (auto& reader : readers)
+        reader.join();
+
+    EXPECT_EQ(beyond.load(), 4 * 1000);
+    EXPECT_EQ(lazy.generate_until(10000), 5000u);
+}
@@ -0,0 +1,75 @@
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <string>
+#include "CoroutineGenerator.hpp"
+#include "LazySequence.hpp"
+
+static Coroutine<int> naturals()
+{
+    for (int i = 0;; ++i)
+        co_yield i;
+}
+
+static Coroutine<int> range(int from, int to)
+{
+    for (int i = from; i < to; ++i)
+        co_yield i;
+}
+
+// a filter needs no lookahead of its own: the predicate runs between
+// two yields
+static Coroutine<int> multiples_of(std::shared_ptr<LazySequence<int>> seq, int divisor)
+{
+    for (size_t i = 0; i < seq->get_materialized_count() || seq->has_next(); ++i)
+    {
+        int x = seq->get(i);
+        if (x % divisor == 0)
+            co_yield x;
+    }
+}
+
+static Coroutine<int> nested()
+{
+    co_yield -1;
+    co_yield range(0, 3);
+    co_yield range(5, 5);
+    co_yield range(10, 12);
+    co_yield -2;
+}
+
+static Coroutine<int> failing()
+{
+    co_yield 1;
+    throw std::invalid_argument("source failed");
+}
+
+TEST(Coroutine, WrapsIntoLazySequence) {
+    auto lazy = LazySequence<int>::create(std::make_unique<Coroutine_Generator<int>>(naturals()));
+    EXPECT_EQ(lazy->get(10000), 10000);
+
+    auto squares = lazy->map<std::string>([](const int& x) { return std::to_string(x * x); });
+    EXPECT_EQ(squares->get(12), "144");
+
+    ArraySequence<int> numbers;
+    for (int i = 1; i <= 20; ++i)
+        numbers.append(i);
+
+    auto sevens = LazySequence<int>::create(std::make_unique<Coroutine_Generator<int>>(
+        multiples_of(LazySequence<int>::create(numbers), 7)));
+    EXPECT_EQ(sevens->get(0), 7);
+    EXPECT_EQ(sevens->get(1), 14);
+    EXPECT_FALSE(sevens->has_next());
+}
+
+TEST(Coroutine, YieldsNestedCoroutinesAndExceptions) {
+    Coroutine_Generator<int> gen(nested());
+    std::string seen;
+    while (gen.has_next())
+        seen += std::to_string(gen.get_next()) + " ";
+    EXPECT_EQ(seen, "-1 0 1 2 10 11 -2 ");
+
+    Coroutine_Generator<int> broken(failing());
+    EXPECT_EQ(broken.get_next(), 1);
+    EXPECT_THROW(broken.has_next(), std::invalid_argument);
+    EXPECT_FALSE(broken.has_next());
+}
@@ -0,0 +1,160 @@
+#include <gtest/gtest.h>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <string>
+#include "DynamicArray.hpp"
+
+TEST(DynamicArray, ReserveGrowsToRequestedCapacity) {
+    DynamicArray<int> array;
+    array.reserve(100);
+
+    EXPECT_EQ(array.get_capacity(), 100);
+    EXPECT_EQ(array.get_size(), 0);
+
+    for (int i = 0; i < 100; ++i)
+        array.push_back(i);
+
+    EXPECT_EQ(array.get_capacity(), 100);
+    EXPECT_EQ(array.get(99), 99);
+}
+
+TEST(DynamicArray, ShrinkToFitKeepsElements) {
+    DynamicArray<std::string> array;
+    for (int i = 0; i < 5; ++i)
+        array.push_back(std::to_string(i));
+
+    array.shrink_to_fit();
+
+    EXPECT_EQ(array.get_capacity(), 5);
+    EXPECT_EQ(array.get(0), "0");
+    EXPECT_EQ(array.get(4), "4");
+}
+
+TEST(DynamicArray, PushFrontShiftsElements) {
+    DynamicArray<std::string> array;
+    array.push_back("b");
+    array.push_back("c");
+    array.push_front("a");
+
+    EXPECT_EQ(array.get_size(), 3);
+    EXPECT_EQ(array.get(0), "a");
+    EXPECT_EQ(array.get(1), "b");
+    EXPECT_EQ(array.get(2), "c");
+}
+
+TEST(DynamicArray, PushBackOwnElementSurvivesGrowth) {
+    DynamicArray<std::string> array;
+    array.push_back("first");
+
+    for (int i = 0; i < 10; ++i)
+        array.push_back(array.get(0));
+
+    EXPECT_EQ(array.get_size(), 11);
+    EXPECT_EQ(array.get(10), "first");
+}
+
+TEST(DynamicArray, ResizeConstructsAndDestroys) {
+    auto tracked = std::make_shared<int>(0);
+
+    DynamicArray<std::shared_ptr<int>> array;
+    array.push_back(tracked);
+    array.push_back(tracked);
+    EXPECT_EQ(tracked.use_count(), 3);
+
+    array.resize(1);
+    EXPECT_EQ(tracked.use_count(), 2);
+
+    array.resize(3);
+    EXPECT_EQ(array.get_size(), 3);
+    EXPECT_EQ(array.get(2), nullptr);
+
+    array.reset();
+    EXPECT_EQ(tracked.use_count(), 1);
+}
+
+TEST(DynamicArray, GrowsFromBothEnds) {
+    DynamicArray<std::string> array;
+    for (int i = 0; i < 100; ++i) {
+        array.push_back("b" + std::to_string(i));
+        array.push_front("f" + std::to_string(i));
+    }
+
+    EXPECT_EQ(array.get_size(), 200);
+    EXPECT_EQ(array.get(0), "f99");
+    EXPECT_EQ(array.get(99), "f0");
+    EXPECT_EQ(array.get(100), "b0");
+    EXPECT_EQ(array.get(199), "b99");
+}
+
+TEST(DynamicArray, PushFrontKeepsHeadroom) {
+    DynamicArray<int> array;
+    array.push_front(0);
+
+    int relocations = 0;
+    const int* oldest = &array.get(0);
+
+    for (int i = 1; i < 10000; ++i) {
+        array.push_front(i);
+        if (&array.get(i) != oldest) {
+            ++relocations;
+            oldest = &array.get(i);
+        }
+    }
+
+    EXPECT_EQ(array.get(0), 9999);
+    EXPECT_EQ(array.get(9999), 0);
+    EXPECT_LT(relocations, 40);
+}
+
+TEST(DynamicArray, InsertAndEraseRanges) {
+    DynamicArray<std::string> array;
+    std::string words[] = { "a", "b", "c", "d", "e", "f" };
+
+    array.append_range(words, 2);
+    array.insert_range(0, words + 4, 2);
+    array.insert_range(2, words + 2, 2);
+
+    std::string joined;
+    for (int i = 0; i < array.get_size(); ++i)
+        joined += array.get(i);
+    EXPECT_EQ(joined, "efcdab");
+
+    array.erase_range(1, 2);
+    array.erase_range(2, 2);
+
+    ASSERT_EQ(array.get_size(), 2);
+    EXPECT_EQ(array.get(0), "e");
+    EXPECT_EQ(array.get(1), "d");
+}
+
+TEST(DynamicArray, SharedBlockIsCopiedOnWrite) {
+    DynamicArray<std::string> array;
+    for (int i = 0; i < 4; ++i)
+        array.push_back(std::to_string(i));
+
+    DynamicArray<std::string> shared = array.share();
+    EXPECT_EQ(shared.get_data(), array.get_data());
+
+    shared.push_back("4");
+    array.set(0, "zero");
+
+    EXPECT_NE(shared.get_data(), array.get_data());
+    EXPECT_EQ(array.get_size(), 4);
+    EXPECT_EQ(array.get(0), "zero");
+    EXPECT_EQ(shared.get(0), "0");
+    EXPECT_EQ(shared.get(4), "4");
+}
+
+TEST(DynamicArray, FailedMoveAcrossResourcesThrows) {
+    DynamicArray<int> source;
+    for (int i = 0; i < 4; ++i)
+        source.push_back(i);
+
+    DynamicArray<int> target(std::pmr::null_memory_resource());
+    EXPECT_THROW(target = std::move(source), std::bad_alloc);
+
+    EXPECT_EQ(target.get_size(), 0);
+    EXPECT_EQ(source.get_size(), 4);
+    EXPECT_EQ(source.get(3), 3);
+}
@@ -0,0 +1,46 @@
+#include <gtest/gtest.h>
+#include <string>
+#include "LazyPipeline.hpp"
+
+TEST(LazyPipeline, MapWhereReduceInOnePass) {
+    ArraySequence<int> numbers;
+    for (int i = 1; i <= 10; ++i)
+        numbers.append(i);
+
+    auto squares = make_pipeline(numbers)
+        .map([](int x) { return x * x; })
+        .where([](int x) { return x % 2 == 0; });
+
+    auto labels = squares.map([](int x) { return std::to_string(x); });
+    numbers.set(1, 100);
+
+    EXPECT_EQ(squares.sum(), 4 + 16 + 36 + 64 + 100);
+    EXPECT_EQ(squares.count(), 0u);
+
+    std::string first;
+    ASSERT_TRUE(labels.next(first));
+    EXPECT_EQ(first, "4");
+
+    ArraySequence<std::string> rest = labels.to_array();
+    ASSERT_EQ(rest.get_size(), 4);
+    EXPECT_EQ(rest[3], "100");
+    EXPECT_FALSE(labels.next(first));
+}
+
+TEST(LazyPipeline, ErasesToLazySequence) {
+    ArraySequence<long long> numbers;
+    for (int i = 0; i < 5000; ++i)
+        numbers.append(i);
+
+    auto erased = make_pipeline(numbers)
+        .map([](long long x) { return x * 3; })
+        .where([](long long x) { return x % 2 == 1; })
+        .erase();
+
+    EXPECT_EQ(erased->get(0), 3);
+    EXPECT_EQ(erased->get(2499), 14997);
+    EXPECT_THROW(erased->get(2500), std::runtime_error);
+
+    auto halves = erased->map<long long>([](const long long& x) { return x / 3; });
+    EXPECT_EQ(halves->get(10), 21);
+}
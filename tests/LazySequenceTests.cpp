@@ -1,6 +1,13 @@
 #include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <memory_resource>
+#include <sstream>
+#include <string>
+#include <thread>
 #include "LazySequence.hpp"
 #include "ArraySequence.hpp"
+#include "ReadOnlyStream.hpp"
 
 TEST(LazySequence, CreateFromSequence) {
     ArraySequence<int> seq;
@@ -16,6 +23,18 @@ TEST(LazySequence, CreateFromSequence) {
     EXPECT_EQ(lazy->get_materialized_count(), 3);
 }
 
+TEST(LazySequence, SourceWritesDoNotReachTheCache) {
+    ArraySequence<int> seq;
+    for (int i = 0; i < 8; ++i)
+        seq.append(i);
+
+    auto lazy = LazySequence<int>::create(seq);
+    seq[1] = 77;
+
+    EXPECT_EQ(lazy->get(1), 1);
+    EXPECT_EQ(seq.get(1), 77);
+}
+
 TEST(LazySequence, LazyMaterialization) {
     ArraySequence<int> start;
     start.append(1);
@@ -199,4 +218,477 @@ TEST(LazySequence, DoesNotOverGenerate)
 
     EXPECT_EQ(seq->get(3), 2);
     EXPECT_EQ(generated, 2);
-}
\ No newline at end of file
+}
+
+TEST(LazySequence, PipelineStaysInsideArena) {
+    alignas(std::max_align_t) static unsigned char storage[1 << 16];
+    std::pmr::monotonic_buffer_resource arena(
+        storage, sizeof(storage), std::pmr::null_memory_resource()
+    );
+
+    ArraySequence<int> seq;
+    for (int i = 0; i < 100; ++i)
+        seq.append(i);
+
+    auto lazy = LazySequence<int>::create(seq, &arena);
+
+    auto result = lazy
+        ->map<int>([](int x) { return x * 3; })
+        ->where([](int x) { return x % 2 == 0; })
+        ->get_subsequence(5, 10);
+
+    EXPECT_EQ(result->get_memory_resource(), &arena);
+    EXPECT_EQ(result->get(0), 30);
+    EXPECT_EQ(result->get(5), 60);
+}
+
+TEST(LazySequence, BatchedPullMatchesElementwise) {
+    ArraySequence<int> numbers;
+    for (int i = 0; i < 3000; ++i)
+        numbers.append(i);
+
+    ArraySequence<int> marker;
+    marker.append(-1);
+
+    auto build = [&] {
+        auto base = LazySequence<int>::create(numbers);
+        return base
+            ->map<int>([](const int& x) { return x * 3; })
+            ->where([](int x) { return x % 2 == 0; })
+            ->append(LazySequence<int>::create(numbers))
+            ->insert_at(1500, LazySequence<int>::create(marker))
+            ->get_subsequence(10, 3500);
+    };
+
+    auto batched = build();
+    auto elementwise = build();
+
+    EXPECT_EQ(batched->get(3490), 1999);
+    ASSERT_EQ(batched->get_materialized_count(), 3491u);
+
+    for (size_t i = 0; i <= 3490; ++i)
+        ASSERT_EQ(elementwise->get_next(), batched->get(i)) << "at " << i;
+
+    EXPECT_EQ(batched->get(1490), -1);
+    EXPECT_THROW(batched->get(3491), std::runtime_error);
+}
+
+TEST(LazySequence, BatchedRecurrenceGeneratesExactly) {
+    int generated = 0;
+
+    ArraySequence<long long> start;
+    start.append(0);
+    start.append(1);
+
+    auto rule = [&generated](const ArraySequence<long long>& seq) {
+        ++generated;
+        return seq.get(0) + seq.get(1);
+    };
+
+    auto seq = LazySequence<long long>::create(start, 2, rule);
+
+    Span<const long long> first = seq->materialize(0, 50);
+    ASSERT_EQ(first.size(), 50u);
+    EXPECT_EQ(first[49], 7778742049LL);
+    EXPECT_EQ(generated, 48);
+
+    EXPECT_EQ(seq->get(90), 2880067194370816120LL);
+    EXPECT_EQ(generated, 89);
+}
+
+TEST(LazySequence, SlidingWindowReleasesOldElements) {
+    ArraySequence<int> numbers;
+    for (int i = 0; i < 100; ++i)
+        numbers.append(i);
+
+    auto lazy = LazySequence<int>::create(numbers);
+    lazy->set_retention(RetentionPolicy::sliding_window(10));
+
+    EXPECT_EQ(lazy->get(50), 50);
+    EXPECT_EQ(lazy->get(60), 60);
+
+    EXPECT_EQ(lazy->get_released_count(), 41u);
+    EXPECT_EQ(lazy->get_materialized_count(), 61u);
+    EXPECT_EQ(lazy->get_first_materialized(), 41);
+    EXPECT_EQ(lazy->get(51), 51);
+    EXPECT_THROW(lazy->get(50), std::runtime_error);
+
+    int fib_calls = 0;
+    ArraySequence<long long> start;
+    start.append(0);
+    start.append(1);
+
+    auto fib = LazySequence<long long>::create(start, 2,
+        [&fib_calls](const ArraySequence<long long>& s) {
+            ++fib_calls;
+            return s.get(0) + s.get(1);
+        });
+    fib->set_retention(RetentionPolicy::sliding_window(1));
+
+    // the window already holds only the second start element
+    EXPECT_THROW(fib->get(0), std::runtime_error);
+    for (size_t i = 1; i <= 90; ++i)
+        fib->get(i);
+
+    EXPECT_EQ(fib->get(90), 2880067194370816120LL);
+    EXPECT_EQ(fib_calls, 89);
+    EXPECT_LE(fib->get_materialized_count() - fib->get_released_count(), 3u);
+}
+
+TEST(LazySequence, SlidingWindowRejectsReadsBelowIt) {
+    ArraySequence<int> start;
+    start.append(0);
+
+    auto lazy = LazySequence<int>::create(start, 1,
+        [](const ArraySequence<int>& s) { return s[0] + 1; });
+    lazy->set_retention(RetentionPolicy::sliding_window(10));
+
+    EXPECT_EQ(lazy->get(999), 999);
+    EXPECT_THROW(lazy->materialize(500, 600), std::runtime_error);
+    EXPECT_THROW(lazy->get(500), std::runtime_error);
+
+    Span<const int> tail = lazy->materialize(990, 20);
+    ASSERT_EQ(tail.size(), 20u);
+    EXPECT_EQ(tail[0], 990);
+    EXPECT_EQ(tail[19], 1009);
+}
+
+TEST(LazySequence, ForwardScanKeepsConstantMemory) {
+    std::string text;
+    for (int i = 0; i < 10000; ++i)
+        text += "ab ";
+
+    std::istringstream input(text);
+    auto lazy = std::make_shared<LazySequence<char>>(
+        std::make_unique<Stream_Generator<char>>(input));
+    lazy->set_retention(RetentionPolicy::release_below_cursor());
+
+    ReadOnlyStream<char> stream(lazy);
+    stream.open();
+
+    size_t read = 0;
+    size_t most_retained = 0;
+    while (!stream.is_end_of_stream()) {
+        stream.read();
+        ++read;
+        most_retained = std::max(
+            most_retained, lazy->get_materialized_count() - lazy->get_released_count());
+    }
+
+    EXPECT_EQ(read, text.size());
+    EXPECT_LE(most_retained, 2u);
+}
+
+TEST(LazySequence, FusedStagesSkipIntermediateCaches) {
+    ArraySequence<int> numbers;
+    for (int i = 0; i < 1000; ++i)
+        numbers.append(i);
+
+    int squared = 0;
+    auto base = LazySequence<int>::create(numbers);
+    auto squares = base->map<int>([&squared](const int& x) { ++squared; return x * x; });
+    auto even = squares->where([](int x) { return x % 2 == 0; });
+    auto labels = even->map<std::string>([](const int& x) { return std::to_string(x); });
+
+    EXPECT_EQ(labels->get(10), "400");
+    EXPECT_EQ(labels->get_materialized_count(), 11u);
+    EXPECT_EQ(base->get_materialized_count(), 0u);
+    EXPECT_EQ(squares->get_materialized_count(), 0u);
+    EXPECT_EQ(even->get_materialized_count(), 0u);
+    EXPECT_EQ(squared, 21);
+
+    // indexing an intermediate stage caches it, and later stages read that
+    // cache instead of recomputing
+    EXPECT_EQ(squares->get(30), 900);
+    auto shifted = squares->map<int>([](const int& x) { return x + 1; });
+    EXPECT_EQ(shifted->get(30), 901);
+    EXPECT_EQ(squared, 21 + 31);
+}
+
+TEST(LazySequence, StagesReuseACacheFilledAfterTheyWereBuilt) {
+    ArraySequence<int> numbers;
+    for (int i = 0; i < 100; ++i)
+        numbers.append(i);
+
+    int mapped_calls = 0;
+    int filtered_calls = 0;
+    auto base = LazySequence<int>::create(numbers);
+    auto tripled = base->map<int>([&mapped_calls](const int& x) { ++mapped_calls; return 3 * x; });
+    auto odd = tripled->where([&filtered_calls](int x) { ++filtered_calls; return x % 2 != 0; });
+
+    EXPECT_EQ(tripled->get(99), 297);
+    EXPECT_EQ(odd->get(49), 297);
+    EXPECT_FALSE(odd->has_next());
+
+    EXPECT_EQ(mapped_calls, 100);
+    EXPECT_EQ(filtered_calls, 100);
+}
+
+TEST(LazySequence, LinearRecurrenceJumpsToFarIndices) {
+    ArraySequence<unsigned long long> start;
+    start.append(0);
+    start.append(1);
+
+    ArraySequence<unsigned long long> fib_coefficients;
+    fib_coefficients.append(1);
+    fib_coefficients.append(1);
+
+    auto fib = LazySequence<unsigned long long>::create_linear(start, fib_coefficients);
+
+    EXPECT_EQ(fib->get(90), 2880067194370816120ULL);
+    EXPECT_EQ(fib->get_materialized_count(), 91u);
+
+    EXPECT_EQ(fib->get(1000000000000ULL), 17027753439760716347ULL);
+    EXPECT_EQ(fib->get_materialized_count(), 91u);
+
+    // tribonacci: stepping the general rule and jumping agree
+    ArraySequence<unsigned long long> trib_start;
+    trib_start.append(0);
+    trib_start.append(0);
+    trib_start.append(1);
+
+    ArraySequence<unsigned long long> ones;
+    for (int i = 0; i < 3; ++i)
+        ones.append(1);
+
+    auto stepped = LazySequence<unsigned long long>::create(trib_start, 3,
+        [](const ArraySequence<unsigned long long>& s) { return s[0] + s[1] + s[2]; });
+    auto jumped = LazySequence<unsigned long long>::create_linear(trib_start, ones);
+
+    EXPECT_EQ(stepped->get(5000), 17044449791406917144ULL);
+    EXPECT_EQ(jumped->get(5000), 17044449791406917144ULL);
+    EXPECT_EQ(jumped->get_materialized_count(), 3u);
+}
+
+TEST(LazySequence, SubsequenceSkipsRandomAccessPrefix) {
+    ArraySequence<long long> numbers(1000000);
+    for (int i = 0; i < 1000000; ++i)
+        numbers[i] = i;
+
+    int mapped = 0;
+    auto base = LazySequence<long long>::create(numbers);
+    auto tripled = base->map<long long>([&mapped](const long long& x) { ++mapped; return x * 3; });
+    auto window = tripled->append(base)->get_subsequence(1900000, 1900010);
+
+    EXPECT_EQ(window->get(0), 900000);
+    EXPECT_EQ(window->get(10), 900010);
+    EXPECT_FALSE(window->get_subsequence(11, 20)->has_next());
+    EXPECT_EQ(mapped, 0);
+
+    auto middle = tripled->get_subsequence(900000, 900010);
+    EXPECT_EQ(middle->get(10), 2700030);
+    EXPECT_EQ(mapped, 11);
+
+    // a filter cannot skip without testing, but still caches nothing
+    auto odd = base->where([](long long x) { return x % 2 == 1; })->get_subsequence(1000, 1001);
+    EXPECT_EQ(odd->get(0), 2001);
+    EXPECT_EQ(odd->get(1), 2003);
+    EXPECT_EQ(base->get_materialized_count(), 0u);
+}
+
+TEST(LazySequence, SkipPastTheCacheCachesNothingMore) {
+    ArraySequence<long long> numbers(2000000);
+    for (int i = 0; i < 2000000; ++i)
+        numbers[i] = i;
+
+    auto base = LazySequence<long long>::create(numbers);
+    EXPECT_EQ(base->get(0), 0);
+
+    auto window = base->get_subsequence(1900000, 1900010);
+    EXPECT_EQ(window->get(0), 1900000);
+    EXPECT_EQ(window->get(10), 1900010);
+    EXPECT_EQ(base->get_materialized_count(), 1u);
+
+    // a skip inside the cache still reads it
+    EXPECT_EQ(base->get(99), 99);
+    EXPECT_EQ(base->get_subsequence(50, 60)->get(10), 60);
+    EXPECT_EQ(base->get_materialized_count(), 100u);
+}
+
+TEST(LazySequence, PrefetchRunsAheadWithinCapacity) {
+    std::string text;
+    for (int i = 0; i < 20000; ++i)
+        text += static_cast<char>('a' + i % 26);
+
+    std::istringstream input(text);
+    auto chars = std::make_shared<LazySequence<char>>(
+        std::make_unique<Stream_Generator<char>>(input));
+    chars->set_retention(RetentionPolicy::release_below_cursor());
+    chars->prefetch(512);
+
+    ReadOnlyStream<char> stream(chars);
+    stream.open();
+    std::string read;
+    while (!stream.is_end_of_stream())
+        read += stream.read();
+    EXPECT_EQ(read, text);
+
+    // an endless recurrence stops once the ring is full
+    std::atomic<int> steps(0);
+    ArraySequence<int> start;
+    start.append(0);
+    auto counter = LazySequence<int>::create(start, 1,
+        [&steps](const ArraySequence<int>& s) { ++steps; return s[0] + 1; });
+    counter->prefetch(256);
+
+    EXPECT_EQ(counter->get(100), 100);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_LE(steps.load(), 100 + 256);
+    EXPECT_GE(steps.load(), 100);
+}
+
+TEST(LazySequence, ParallelMapKeepsOrderAndBoundedLookahead) {
+    ArraySequence<int> numbers;
+    for (int i = 0; i < 10000; ++i)
+        numbers.append(i);
+
+    ThreadPool pool(4);
+    std::atomic<int> calls(0);
+    auto base = LazySequence<int>::create(numbers);
+    auto squares = base->map_parallel<long long>([&calls](const int& x) {
+        ++calls;
+        return static_cast<long long>(x) * x;
+    }, 64, pool);
+
+    EXPECT_EQ(squares->get(10), 100);
+    EXPECT_LE(calls.load(), 64);
+
+    EXPECT_EQ(squares->get(9999), 9999LL * 9999);
+    for (int i = 0; i < 10000; i += 37)
+        EXPECT_EQ(squares->get(i), static_cast<long long>(i) * i);
+    EXPECT_EQ(calls.load(), 10000);
+
+    auto tail = base->map_parallel<long long>([&calls](const int& x) {
+        ++calls;
+        return static_cast<long long>(x);
+    }, 64, pool)->get_subsequence(9000, 9009);
+    EXPECT_EQ(tail->get(9), 9009);
+    EXPECT_LE(calls.load(), 10000 + 64);
+}
+
+TEST(LazySequence, SizeHintsFollowTheGeneratorGraph) {
+    ArraySequence<int> numbers;
+    for (int i = 0; i < 1000; ++i)
+        numbers.append(i);
+
+    auto base = LazySequence<int>::create(numbers);
+    auto squares = base->map<int>([](const int& x) { return x * x; });
+    auto both = squares->append(base);
+
+    EXPECT_EQ(both->size(), 2000u);
+    EXPECT_EQ(both->insert_at(500, base)->size(), 2001u);
+    EXPECT_EQ(both->insert_at(5000, base)->size(), 2000u);
+    EXPECT_EQ(both->get_subsequence(1990, 2100)->size(), 10u);
+    EXPECT_EQ(base->get_materialized_count(), 0u);
+
+    // reading part of it keeps the hint right
+    EXPECT_EQ(both->get(10), 100);
+    EXPECT_EQ(both->size(), 2000u);
+
+    auto even = squares->where([](int x) { return x % 2 == 0; });
+    EXPECT_FALSE(even->size().has_value());
+    EXPECT_EQ(even->size_hint().kind, SizeHint::Kind::bounded);
+    EXPECT_EQ(even->size_hint().value, 1000u);
+
+    ArraySequence<int> start;
+    start.append(1);
+    auto endless = LazySequence<int>::create(start, 1,
+        [](const ArraySequence<int>& s) { return s[0] + 1; });
+    EXPECT_FALSE(endless->size_hint().is_known());
+
+    std::istringstream input("some text");
+    auto chars = std::make_shared<LazySequence<char>>(
+        std::make_unique<Stream_Generator<char>>(input));
+    EXPECT_EQ(chars->size_hint().value, 9u);
+    EXPECT_EQ(chars->get(8), 't');
+    EXPECT_FALSE(chars->has_next());
+    EXPECT_EQ(chars->size(), 9u);
+}
+
+TEST(LazySequence, TerminalOperationsCacheNothing) {
+    ArraySequence<long long> numbers;
+    for (int i = 1; i <= 100000; ++i)
+        numbers.append(i);
+
+    auto base = LazySequence<long long>::create(numbers);
+    auto odd = base->where([](long long x) { return x % 2 == 1; });
+
+    EXPECT_EQ(odd->sum(), 2500000000LL);
+    EXPECT_EQ(odd->count(), 50000u);
+    EXPECT_EQ(odd->min(), 1);
+    EXPECT_EQ(odd->max(), 99999);
+    EXPECT_EQ(odd->fold(std::string(), [](std::string s, long long x) {
+        return s.size() < 5 ? s + std::to_string(x) : s;
+    }), "13579");
+    EXPECT_EQ(odd->get_materialized_count(), 0u);
+    EXPECT_EQ(base->get_materialized_count(), 0u);
+
+    int tested = 0;
+    EXPECT_TRUE(odd->any_of([&tested](long long x) { ++tested; return x > 10; }));
+    EXPECT_EQ(tested, 6);
+    EXPECT_FALSE(odd->all_of([](long long x) { return x < 99999; }));
+
+    // cached elements are read from the cache, the rest from a fork
+    EXPECT_EQ(odd->get(2), 5);
+    EXPECT_EQ(odd->count(), 50000u);
+    EXPECT_EQ(odd->reduce([](long long a, long long b) { return a + b; }), 2500000000LL);
+    EXPECT_EQ(odd->get_materialized_count(), 3u);
+
+    EXPECT_THROW(LazySequence<int>::create()->min(), std::runtime_error);
+
+    // a stream is drained and used up
+    std::istringstream input("abcabcab");
+    auto chars = std::make_shared<LazySequence<char>>(
+        std::make_unique<Stream_Generator<char>>(input));
+    EXPECT_EQ(chars->get(0), 'a');
+    size_t seen = 0;
+    chars->for_each([&seen](char c) { seen += c == 'a'; });
+    EXPECT_EQ(seen, 3u);
+    EXPECT_EQ(chars->get_materialized_count(), 8u);
+    EXPECT_THROW(chars->get(1), std::runtime_error);
+    EXPECT_FALSE(chars->has_next());
+}
+
+TEST(LazySequence, AppendReleasesExhaustedParts) {
+    std::istringstream inputs[3] = {
+        std::istringstream("abc"), std::istringstream("def"), std::istringstream("gh")
+    };
+
+    std::weak_ptr<LazySequence<char>> parts[3];
+    std::shared_ptr<LazySequence<char>> all;
+    for (int i = 0; i < 3; ++i) {
+        auto part = std::make_shared<LazySequence<char>>(
+            std::make_unique<Stream_Generator<char>>(inputs[i]));
+        parts[i] = part;
+        all = all ? all->append(part) : part;
+    }
+
+    EXPECT_EQ(all->size_hint().value, 8u);
+    EXPECT_EQ(all->get(0), 'a');
+    EXPECT_FALSE(parts[0].expired());
+
+    EXPECT_EQ(all->get(4), 'e');
+    EXPECT_TRUE(parts[0].expired());
+    EXPECT_FALSE(parts[1].expired());
+
+    EXPECT_EQ(all->get(7), 'h');
+    EXPECT_FALSE(all->has_next());
+    EXPECT_TRUE(parts[1].expired());
+    EXPECT_TRUE(parts[2].expired());
+    EXPECT_EQ(all->get(3), 'd');
+    EXPECT_EQ(all->size(), 8u);
+
+    // insert_at asks secondary for one element only and then lets it go
+    ArraySequence<int> numbers;
+    for (int i = 0; i < 10; ++i)
+        numbers.append(i);
+    auto marker = LazySequence<int>::create(numbers)->map<int>([](const int& x) { return -x; });
+    std::weak_ptr<LazySequence<int>> watch = marker;
+
+    auto marked = LazySequence<int>::create(numbers)->insert_at(3, marker);
+    marker.reset();
+    EXPECT_EQ(marked->get(3), 0);
+    EXPECT_EQ(marked->get(4), 3);
+    EXPECT_TRUE(watch.expired());
+    EXPECT_EQ(marked->size(), 11u);
+}
@@ -0,0 +1,73 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include "ParallelOperations.hpp"
+
+static ArraySequence<int> make_range(int count)
+{
+    ArraySequence<int> seq(count);
+    for (int i = 0; i < count; ++i)
+        seq[i] = i;
+    return seq;
+}
+
+TEST(ParallelOperations, MapMatchesSerialMap) {
+    ThreadPool pool(4);
+    ArraySequence<int> seq = make_range(100000);
+
+    auto squares = parallel_map(seq, [](int x) { return static_cast<long long>(x) * x; }, pool);
+
+    ASSERT_EQ(squares.get_size(), 100000);
+    for (int i = 0; i < squares.get_size(); i += 997)
+        EXPECT_EQ(squares[i], static_cast<long long>(i) * i);
+}
+
+TEST(ParallelOperations, WhereIsStable) {
+    ThreadPool pool(3);
+    ArraySequence<int> seq = make_range(50000);
+
+    auto multiples = parallel_where(seq, [](int x) { return x % 7 == 0; }, pool);
+
+    ASSERT_EQ(multiples.get_size(), (50000 + 6) / 7);
+    for (int i = 0; i < multiples.get_size(); ++i)
+        ASSERT_EQ(multiples[i], i * 7);
+}
+
+TEST(ParallelOperations, ReduceSumsAllChunks) {
+    ThreadPool pool(4);
+    ArraySequence<int> seq = make_range(100000);
+
+    long long sum = parallel_reduce(
+        parallel_map(seq, [](int x) { return static_cast<long long>(x); }, pool),
+        0LL, [](long long a, long long b) { return a + b; }, pool);
+
+    EXPECT_EQ(sum, 100000LL * 99999 / 2);
+}
+
+TEST(ParallelOperations, RethrowsWorkerExceptions) {
+    ThreadPool pool(4);
+    ArraySequence<int> seq = make_range(100000);
+
+    EXPECT_THROW(parallel_map(seq, [](int x) {
+        if (x == 99999)
+            throw std::runtime_error("bad element");
+        return x;
+    }, pool), std::runtime_error);
+}
+
+TEST(ParallelOperations, NestedCallsInsidePoolTasksFinish) {
+    ThreadPool pool(2);
+    ArraySequence<int> seq = make_range(10000);
+    std::atomic<long long> total{0};
+
+    pool.parallel_for(8, 1, [&](size_t, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+        {
+            int sum = parallel_reduce(seq, 0, [](int a, int b) { return a + b; }, pool);
+            total += sum;
+        }
+    });
+
+    EXPECT_EQ(total.load(), 8 * (10000LL * 9999 / 2));
+}
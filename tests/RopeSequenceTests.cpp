@@ -0,0 +1,114 @@
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include "ArraySequence.hpp"
+#include "LazySequence.hpp"
+#include "RopeSequence.hpp"
+
+static void expect_same(const Sequence<int>& actual, const Sequence<int>& expected)
+{
+    ASSERT_EQ(actual.get_size(), expected.get_size());
+    for (int i = 0; i < expected.get_size(); ++i)
+        ASSERT_EQ(actual.get(i), expected.get(i)) << "at index " << i;
+}
+
+TEST(RopeSequence, RandomEditsMatchArraySequence) {
+    RopeSequence<int> rope;
+    ArraySequence<int> reference;
+
+    unsigned state = 12345;
+    auto next = [&state](int bound) {
+        state = state * 1103515245u + 12345u;
+        return static_cast<int>((state >> 8) % static_cast<unsigned>(bound));
+    };
+
+    for (int step = 0; step < 20000; ++step) {
+        int size = reference.get_size();
+        int action = next(10);
+
+        if (action < 6 || size == 0) {
+            int index = next(size + 1);
+            rope.insert(index, step);
+            ArraySequence<int> item(&step, 1);
+            reference.insert_at(index, &item);
+        } else if (action < 9) {
+            int index = next(size);
+            rope.remove(index);
+            reference.remove(index);
+        } else {
+            int index = next(size);
+            rope.set(index, -step);
+            reference.set(index, -step);
+        }
+    }
+
+    expect_same(rope, reference);
+}
+
+TEST(RopeSequence, SubsequenceSharesWithoutAliasing) {
+    ArraySequence<int> source;
+    for (int i = 0; i < 5000; ++i)
+        source.append(i);
+
+    RopeSequence<int> rope(source);
+    std::unique_ptr<RopeSequence<int>> middle(rope.get_subsequence(1000, 2999));
+    RopeSequence<int> copy(rope);
+
+    middle->set(0, -1);
+    copy.remove(0);
+    rope.prepend(-2);
+
+    ASSERT_EQ(middle->get_size(), 2000);
+    EXPECT_EQ(middle->get(0), -1);
+    EXPECT_EQ(middle->get_last(), 2999);
+    EXPECT_EQ(copy.get_first(), 1);
+    EXPECT_EQ(rope.get(1), 0);
+    EXPECT_EQ(rope.get(1001), 1000);
+    EXPECT_THROW(rope.get_subsequence(10, 5), std::out_of_range);
+}
+
+TEST(RopeSequence, CopiesDoNotWriteThroughGet) {
+    RopeSequence<int> a;
+    for (int i = 0; i < 10; ++i)
+        a.append(i);
+
+    RopeSequence<int> b(a);
+    static_assert(std::is_same_v<decltype(b.get(5)), const int&>);
+    b.set(5, 999);
+
+    EXPECT_EQ(a.get(5), 5);
+    EXPECT_EQ(b.get(5), 999);
+}
+
+TEST(RopeSequence, InsertAtSplicesOtherSequences) {
+    int items[] = { 0, 1, 2, 3 };
+    RopeSequence<int> rope(items, 4);
+    ArraySequence<int> reference(items, 4);
+
+    ArraySequence<int> plain(items, 2);
+    rope.insert_at(2, &plain);
+    reference.insert_at(2, &plain);
+
+    rope.insert_at(3, &rope);
+    reference.insert_at(3, &reference);
+
+    expect_same(rope, reference);
+
+    auto lazy = LazySequence<int>::create(rope);
+    EXPECT_EQ(lazy->get(5), reference.get(5));
+}
+
+TEST(RopeSequence, MapKeepsOrder) {
+    RopeSequence<std::string> rope;
+    for (int i = 0; i < 300; ++i)
+        rope.append(std::to_string(i));
+
+    std::unique_ptr<RopeSequence<std::string>> mapped(
+        rope.map([](std::string s) { return s + "!"; }));
+
+    ASSERT_EQ(mapped->get_size(), 300);
+    EXPECT_EQ(mapped->get(0), "0!");
+    EXPECT_EQ(mapped->get(299), "299!");
+    EXPECT_EQ(rope.get(299), "299");
+}
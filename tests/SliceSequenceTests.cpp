@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+#include <memory>
+#include <numeric>
+#include <utility>
+#include "ArraySequence.hpp"
+#include "LazySequence.hpp"
+#include "SliceSequence.hpp"
+
+TEST(SliceSequence, ViewsAndWritesThrough) {
+    ArraySequence<int> storage;
+    for (int i = 0; i < 10; ++i)
+        storage.append(i);
+
+    SliceSequence<int> slice(storage, 2, 7);
+    std::unique_ptr<SliceSequence<int>> inner(slice.get_subsequence(1, 3));
+
+    EXPECT_EQ(slice.get_size(), 6);
+    EXPECT_EQ(slice.get_first(), 2);
+    EXPECT_EQ(inner->as_span().data(), storage.get_data() + 3);
+    EXPECT_EQ(std::accumulate(inner->begin(), inner->end(), 0), 3 + 4 + 5);
+
+    inner->set(0, -3);
+    EXPECT_EQ(storage.get(3), -3);
+
+    EXPECT_THROW(slice.append(1), std::runtime_error);
+    EXPECT_THROW(slice.get(6), std::out_of_range);
+    EXPECT_THROW(slice.get_subsequence(4, 6), std::out_of_range);
+}
+
+TEST(SliceSequence, WritesStayOutOfSharedCopies) {
+    ArraySequence<int> storage;
+    for (int i = 0; i < 10; ++i)
+        storage.append(i);
+    const ArraySequence<int> copy(storage);
+
+    SliceSequence<int> slice(storage, 2, 7);
+    slice.set(0, -2);
+
+    auto source = std::make_shared<ArraySequence<int>>(copy);
+    SharedSliceSequence<int> shared(source, 4, 8);
+    shared.set(0, -4);
+
+    EXPECT_EQ(storage.get(2), -2);
+    EXPECT_EQ(source->get(4), -4);
+    EXPECT_EQ(copy[2], 2);
+    EXPECT_EQ(copy[4], 4);
+}
+
+TEST(SharedSliceSequence, PinsItsSourceAgainstSharing) {
+    auto source = std::make_shared<ArraySequence<int>>();
+    for (int i = 0; i < 10; ++i)
+        source->append(i);
+
+    SharedSliceSequence<int> view(source);
+    {
+        ArraySequence<int> copy(*source);
+        EXPECT_NE(std::as_const(copy).get_data(), std::as_const(*source).get_data());
+        source->get(0);
+        (*source)[3] = 30;
+        copy.set(4, -4);
+    }
+
+    EXPECT_EQ(view.get(3), 30);
+    EXPECT_EQ(view.get(4), 4);
+
+    view.reset();
+    const ArraySequence<int> later(*source);
+    EXPECT_EQ(later.get_data(), std::as_const(*source).get_data());
+}
+
+TEST(SharedSliceSequence, OutlivesItsSource) {
+    std::unique_ptr<SharedSliceSequence<int>> tail;
+    const int* data;
+    {
+        ArraySequence<int> source;
+        for (int i = 0; i < 100; ++i)
+            source.append(i);
+        data = source.get_data();
+
+        SharedSliceSequence<int> whole(std::move(source));
+        tail.reset(whole.get_subsequence(90, 99));
+    }
+
+    EXPECT_EQ(tail->as_span().data(), data + 90);
+    EXPECT_EQ(tail->get_size(), 10);
+    EXPECT_EQ(tail->get_last(), 99);
+}
+
+TEST(SharedSliceSequence, LazySequenceWrapsWithoutCopy) {
+    auto source = std::make_shared<ArraySequence<int>>();
+    for (int i = 0; i < 10; ++i)
+        source->append(i * i);
+
+    auto lazy = LazySequence<int>::create(SharedSliceSequence<int>(source, 4, 8));
+
+    source->set(5, -1);
+
+    EXPECT_EQ(lazy->get(0), 16);
+    EXPECT_EQ(lazy->get(1), -1);
+    EXPECT_EQ(lazy->get(4), 64);
+    EXPECT_FALSE(lazy->has_next());
+}